@@ -0,0 +1,121 @@
+#ifndef BENCH_COMMON_HPP
+#define BENCH_COMMON_HPP
+
+#include <platform/window.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace bench {
+
+    using Clock = std::chrono::steady_clock;
+
+    inline double seconds_since(Clock::time_point start) {
+        return std::chrono::duration<double>(Clock::now() - start).count();
+    }
+
+    // Summary of repeated measurements, all in the caller's unit.
+    struct Summary {
+        size_t reps = 0;
+        double min = 0, median = 0, mean = 0, stddev = 0, p95 = 0, max = 0;
+    };
+
+    inline Summary summarize(std::vector<double> samples) {
+        Summary s;
+        s.reps = samples.size();
+        if (samples.empty()) {
+            return s;
+        }
+        std::sort(samples.begin(), samples.end());
+        s.min = samples.front();
+        s.max = samples.back();
+        s.median = samples[samples.size() / 2];
+        s.p95 = samples[std::min(samples.size() - 1, static_cast<size_t>(std::ceil(samples.size() * 0.95)) - 1)];
+        for (double v : samples) {
+            s.mean += v;
+        }
+        s.mean /= samples.size();
+        for (double v : samples) {
+            s.stddev += (v - s.mean) * (v - s.mean);
+        }
+        s.stddev = samples.size() > 1 ? std::sqrt(s.stddev / (samples.size() - 1)) : 0.0;
+        return s;
+    }
+
+    // Backends a benchmark can run against. X11 ones need $DISPLAY, e.g.
+    // from Xvfb on build machines.
+    struct BackendChoice {
+        std::string name; // "headless", "xlib", "software"
+        bool x11;
+        bool software;
+    };
+
+    inline bool display_available() {
+        Display* dpy = XOpenDisplay(nullptr);
+        if (!dpy) {
+            return false;
+        }
+        XCloseDisplay(dpy);
+        return true;
+    }
+
+    // "all" expands to headless plus the X11 backends when a display is
+    // reachable; otherwise a comma-separated list of names.
+    inline std::vector<BackendChoice> parse_backends(const std::string& spec) {
+        std::vector<BackendChoice> all = {{"headless", false, true}, {"xlib", true, false}, {"software", true, true}};
+        std::vector<BackendChoice> out;
+        bool x11 = display_available();
+        for (const BackendChoice& backend : all) {
+            bool wanted = spec == "all" ? (!backend.x11 || x11)
+                                        : ("," + spec + ",").find("," + backend.name + ",") != std::string::npos;
+            if (!wanted) {
+                continue;
+            }
+            if (backend.x11 && !x11) {
+                std::fprintf(stderr, "Skipping %s backend: no X display\n", backend.name.c_str());
+                continue;
+            }
+            out.push_back(backend);
+        }
+        return out;
+    }
+
+    inline bool write_file(const std::string& path, const std::string& text) {
+        std::ofstream file(path, std::ios::trunc);
+        file << text;
+        if (!file) {
+            std::fprintf(stderr, "Failed to write %s\n", path.c_str());
+            return false;
+        }
+        return true;
+    }
+
+    // Value of --name=value, or fallback
+    inline std::string option(int argc, char** argv, const std::string& name, const std::string& fallback) {
+        std::string prefix = "--" + name + "=";
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg.rfind(prefix, 0) == 0) {
+                return arg.substr(prefix.size());
+            }
+        }
+        return fallback;
+    }
+
+    inline bool flag(int argc, char** argv, const std::string& name) {
+        for (int i = 1; i < argc; ++i) {
+            if (argv[i] == "--" + name) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+} // namespace bench
+
+#endif // BENCH_COMMON_HPP
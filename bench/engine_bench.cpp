@@ -0,0 +1,256 @@
+// Renderer micro-benchmarks. Runs headless by default and also against the
+// X11 backends when $DISPLAY is reachable (e.g. under Xvfb):
+//
+//   engine_bench [--backends=all|headless,xlib,software] [--max-shapes=N]
+//                [--max-present=N] [--warmup=N] [--reps=N] [--filter=substr]
+//                [--json=path] [--csv=path]
+//
+// Every benchmark reports the median, mean, standard deviation, min and p95
+// over the timed repetitions; warm-up repetitions are discarded.
+#include "bench_common.hpp"
+#include <platform/renderer.hpp>
+#include <cstdio>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+
+    struct Result {
+        std::string name;
+        std::string backend;
+        size_t n;
+        std::string unit;
+        bench::Summary summary;
+    };
+
+    struct Settings {
+        size_t max_shapes = 1000000;
+        size_t max_present = 100000;
+        int warmup = 2;
+        int reps = 10;
+        std::string filter;
+    };
+
+    class Suite {
+    public:
+        Suite(const Settings& settings, const bench::BackendChoice& backend)
+            : settings_(settings), backend_(backend) {
+            platform::WindowConfig config;
+            config.title = "engine_bench";
+            config.width = 800;
+            config.height = 600;
+            config.backend = backend.x11 ? platform::Backend::X11 : platform::Backend::HEADLESS;
+            window_ = std::make_unique<platform::Window>(config);
+            renderer_ = std::make_unique<platform::Renderer>(
+                *window_, backend.software ? platform::RenderMode::SOFTWARE : platform::RenderMode::XLIB);
+            window_->show();
+            sync();
+        }
+
+        void run(std::vector<Result>& results) {
+            for (size_t n = 1000; n <= settings_.max_shapes; n *= 10) {
+                insert("draw_point", n, results, [this](size_t i) {
+                    renderer_->draw_point(static_cast<int>(i % 800), static_cast<int>(i / 800 % 600), static_cast<int>(i + 1));
+                });
+                insert("draw_line", n, results, [this](size_t i) {
+                    int x = static_cast<int>(i % 780), y = static_cast<int>(i / 780 % 580);
+                    renderer_->draw_line(x, y, x + 20, y + 20, static_cast<int>(i + 1));
+                });
+                insert("draw_rect", n, results, [this](size_t i) {
+                    renderer_->draw_rect(static_cast<int>(i % 780), static_cast<int>(i / 780 % 580), 20, 20, (i & 1) != 0,
+                                         static_cast<int>(i + 1));
+                });
+                remove_by_id(n, results);
+            }
+            set_draw_color(results);
+            for (size_t n = 1000; n <= std::min(settings_.max_shapes, settings_.max_present); n *= 10) {
+                present(n, true, results);
+                present(n, false, results);
+            }
+        }
+
+    private:
+        bool wanted(const std::string& name) const {
+            return settings_.filter.empty() || name.find(settings_.filter) != std::string::npos;
+        }
+
+        // setup() runs untimed before every repetition; body() is timed and
+        // its seconds are divided by `ops` and scaled to `unit`.
+        template <typename Setup, typename Body>
+        void measure(const std::string& name, size_t n, size_t ops, bool ms, std::vector<Result>& results,
+                     Setup&& setup, Body&& body) {
+            if (!wanted(name)) {
+                return;
+            }
+            std::vector<double> samples;
+            for (int rep = -settings_.warmup; rep < settings_.reps; ++rep) {
+                setup();
+                bench::Clock::time_point start = bench::Clock::now();
+                body();
+                double seconds = bench::seconds_since(start);
+                if (rep >= 0) {
+                    samples.push_back(seconds / ops * (ms ? 1e3 : 1e9));
+                }
+            }
+            results.push_back(Result{name, backend_.name, n, ms ? "ms/frame" : "ns/op", bench::summarize(samples)});
+            const bench::Summary& s = results.back().summary;
+            std::printf("%-22s %-9s %8zu %12.3f %12.3f %10.3f %12.3f %12.3f  %s\n", name.c_str(), backend_.name.c_str(),
+                        n, s.median, s.mean, s.stddev, s.min, s.p95, results.back().unit.c_str());
+            std::fflush(stdout);
+        }
+
+        template <typename Draw>
+        void insert(const std::string& name, size_t n, std::vector<Result>& results, Draw&& draw) {
+            measure(name, n, n, false, results, [this] { reset(); }, [&] {
+                for (size_t i = 0; i < n; ++i) {
+                    draw(i);
+                }
+            });
+        }
+
+        // Cost of removing 1000 random ids from a scene of n shapes
+        void remove_by_id(size_t n, std::vector<Result>& results) {
+            const size_t removals = std::min<size_t>(n, 1000);
+            std::vector<int> ids(n);
+            std::iota(ids.begin(), ids.end(), 1);
+            std::mt19937 rng(42);
+            measure("remove_shape_by_id", n, removals, false, results, [&] {
+                reset();
+                for (size_t i = 0; i < n; ++i) {
+                    renderer_->draw_rect(static_cast<int>(i % 780), static_cast<int>(i / 780 % 580), 20, 20, true, ids[i]);
+                }
+                std::shuffle(ids.begin(), ids.end(), rng);
+            }, [&] {
+                for (size_t i = 0; i < removals; ++i) {
+                    renderer_->remove_shape_by_id(ids[i]);
+                }
+            });
+        }
+
+        void set_draw_color(std::vector<Result>& results) {
+            const size_t calls = 100000;
+            measure("set_draw_color", calls, calls, false, results, [] {}, [&] {
+                for (size_t i = 0; i < calls; ++i) {
+                    unsigned char c = static_cast<unsigned char>(i & 63) * 4;
+                    renderer_->set_draw_color(c, static_cast<unsigned char>(255 - c), c, 255);
+                }
+            });
+        }
+
+        // Full repaint of a scene of n rects, or the repaint after moving
+        // one of them. Includes a round trip so X11 backends are measured
+        // until the server has done the work.
+        void present(size_t n, bool full, std::vector<Result>& results) {
+            reset();
+            renderer_->set_draw_color(0, 0, 0, 255);
+            renderer_->draw_rect(0, 0, 800, 600, true, 1);
+            std::mt19937 rng(7);
+            for (size_t i = 1; i < n; ++i) {
+                // 256 distinct colors, well within the shape store palette
+                unsigned char c = static_cast<unsigned char>(rng());
+                renderer_->set_draw_color(c, static_cast<unsigned char>(c * 7), static_cast<unsigned char>(c * 13), 255);
+                renderer_->draw_rect(static_cast<int>(rng() % 780), static_cast<int>(rng() % 580), 20, 20,
+                                     (i & 1) != 0, static_cast<int>(i + 1));
+            }
+            renderer_->set_draw_color(0, 0, 0, 255);
+            renderer_->present();
+            sync();
+            int frame = 0;
+            measure(full ? "present_full" : "present_move_one", n, 1, true, results, [&] {
+                if (full) {
+                    renderer_->invalidate();
+                } else {
+                    renderer_->move_shape_by_id(2, 10 + frame % 700, 10 + frame % 500);
+                }
+                frame++;
+            }, [&] {
+                renderer_->present();
+                sync();
+            });
+        }
+
+        void reset() {
+            renderer_->clear();
+            renderer_->set_draw_color(255, 255, 255, 255);
+        }
+
+        void sync() {
+            if (window_->get_display()) {
+                XSync(window_->get_display(), False);
+            }
+        }
+
+        const Settings& settings_;
+        bench::BackendChoice backend_;
+        std::unique_ptr<platform::Window> window_;
+        std::unique_ptr<platform::Renderer> renderer_;
+    };
+
+    std::string to_json(const std::vector<Result>& results, const Settings& settings) {
+        std::string out = "{\n  \"benchmark\": \"engine_bench\",\n";
+        out += "  \"warmup\": " + std::to_string(settings.warmup) + ",\n";
+        out += "  \"reps\": " + std::to_string(settings.reps) + ",\n  \"results\": [\n";
+        char line[512];
+        for (size_t i = 0; i < results.size(); ++i) {
+            const Result& r = results[i];
+            const bench::Summary& s = r.summary;
+            std::snprintf(line, sizeof(line),
+                          "    {\"name\": \"%s\", \"backend\": \"%s\", \"n\": %zu, \"unit\": \"%s\", \"median\": %.6g, "
+                          "\"mean\": %.6g, \"stddev\": %.6g, \"min\": %.6g, \"p95\": %.6g, \"max\": %.6g, \"reps\": %zu}%s\n",
+                          r.name.c_str(), r.backend.c_str(), r.n, r.unit.c_str(), s.median, s.mean, s.stddev, s.min, s.p95,
+                          s.max, s.reps, i + 1 < results.size() ? "," : "");
+            out += line;
+        }
+        out += "  ]\n}\n";
+        return out;
+    }
+
+    std::string to_csv(const std::vector<Result>& results) {
+        std::string out = "name,backend,n,unit,median,mean,stddev,min,p95,max,reps\n";
+        char line[256];
+        for (const Result& r : results) {
+            const bench::Summary& s = r.summary;
+            std::snprintf(line, sizeof(line), "%s,%s,%zu,%s,%.6g,%.6g,%.6g,%.6g,%.6g,%.6g,%zu\n", r.name.c_str(),
+                          r.backend.c_str(), r.n, r.unit.c_str(), s.median, s.mean, s.stddev, s.min, s.p95, s.max, s.reps);
+            out += line;
+        }
+        return out;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        Settings settings;
+        settings.max_shapes = std::stoul(bench::option(argc, argv, "max-shapes", "1000000"));
+        settings.max_present = std::stoul(bench::option(argc, argv, "max-present", "100000"));
+        settings.warmup = std::stoi(bench::option(argc, argv, "warmup", "2"));
+        settings.reps = std::max(1, std::stoi(bench::option(argc, argv, "reps", "10")));
+        settings.filter = bench::option(argc, argv, "filter", "");
+        std::vector<bench::BackendChoice> backends = bench::parse_backends(bench::option(argc, argv, "backends", "all"));
+
+        std::printf("%-22s %-9s %8s %12s %12s %10s %12s %12s  %s\n", "benchmark", "backend", "n", "median", "mean",
+                    "stddev", "min", "p95", "unit");
+        std::vector<Result> results;
+        for (const bench::BackendChoice& backend : backends) {
+            Suite suite(settings, backend);
+            suite.run(results);
+        }
+
+        std::string json = bench::option(argc, argv, "json", "");
+        if (!json.empty() && !bench::write_file(json, to_json(results, settings))) {
+            return 1;
+        }
+        std::string csv = bench::option(argc, argv, "csv", "");
+        if (!csv.empty() && !bench::write_file(csv, to_csv(results))) {
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "Error: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
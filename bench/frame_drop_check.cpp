@@ -0,0 +1,61 @@
+// Check for the dropped-frame count in FrameStats. Feeds end_frame() exact
+// present-to-present intervals, so it does not depend on how the machine
+// paces real frames. Registered with ctest.
+//
+//   frame_drop_check
+#include <platform/frame_stats.hpp>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+    struct Case {
+        const char* name;
+        std::vector<double> frames_ms; // Intervals after the first frame
+        uint64_t dropped;
+    };
+
+    uint64_t dropped_for(const std::vector<double>& frames_ms, double budget_ms) {
+        platform::FrameStats stats;
+        stats.set_budget_ms(budget_ms);
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        stats.end_frame(now);
+        for (double ms : frames_ms) {
+            now += std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                std::chrono::duration<double, std::milli>(ms));
+            stats.end_frame(now);
+        }
+        return stats.report().dropped;
+    }
+
+} // namespace
+
+int main() {
+    const double budget = 1e3 / 60.0;
+    // 60 Hz pacing with jitter both ways, and the scheduler's timer period
+    // a nanosecond shorter than the budget
+    std::vector<double> steady;
+    for (int i = 0; i < 120; ++i) {
+        steady.push_back(i % 2 ? 16.2 : 17.1);
+    }
+    steady.push_back(16.666666);
+    steady.push_back(24.9); // Late, but under 1.5 budgets
+
+    const Case cases[] = {
+        {"steady 60 Hz", steady, 0},
+        {"one refresh skipped", {2 * budget}, 1},
+        {"2.5 budgets", {2.5 * budget}, 2},
+        {"three budgets", {3 * budget + 1.0}, 2},
+        {"mixed", {budget, 2 * budget, budget, 4 * budget}, 4},
+    };
+    int failed = 0;
+    for (const Case& c : cases) {
+        uint64_t dropped = dropped_for(c.frames_ms, budget);
+        bool ok = dropped == c.dropped;
+        std::printf("%-22s dropped %llu, expected %llu%s\n", c.name, static_cast<unsigned long long>(dropped),
+                    static_cast<unsigned long long>(c.dropped), ok ? "" : "  FAIL");
+        failed += !ok;
+    }
+    return failed ? 1 : 0;
+}
\ No newline at end of file
@@ -0,0 +1,62 @@
+// Frame pacing benchmark. Presents headless frames on a 60 Hz FrameScheduler,
+// then one deliberate stall, and prints the dropped-frame count next to the
+// deadlines the scheduler missed. Wall-clock pacing depends on the machine,
+// so this is not a ctest; frame_drop_check covers the counting itself.
+//
+//   frame_pacing [--frames=N] [--rate=HZ]
+#include "bench_common.hpp"
+#include <platform/frame_scheduler.hpp>
+#include <platform/renderer.hpp>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+
+int main(int argc, char** argv) {
+    try {
+        int frame_count = std::stoi(bench::option(argc, argv, "frames", "120"));
+        double rate_hz = std::stod(bench::option(argc, argv, "rate", "60"));
+
+        platform::WindowConfig config;
+        config.title = "frame_pacing";
+        config.backend = platform::Backend::HEADLESS;
+        platform::Window window(config);
+        platform::Renderer renderer(window, platform::RenderMode::SOFTWARE);
+        platform::FrameScheduler scheduler(window, rate_hz);
+        renderer.frame_stats().set_budget_ms(1e3 / rate_hz);
+        window.show();
+        renderer.set_draw_color(255, 0, 0);
+        platform::ShapeHandle mover = renderer.draw_rect(0, 0, 10, 10, true);
+        renderer.set_draw_color(0, 0, 0);
+
+        // missed() only covers the last wake; keep the running total
+        uint64_t missed = 0;
+        auto frame = [&](int index) {
+            scheduler.wait();
+            missed += scheduler.missed();
+            renderer.move_shape(mover, index % 600, 10);
+            renderer.present();
+        };
+        for (int i = 0; i < frame_count; ++i) {
+            frame(i);
+        }
+        platform::FrameReport steady = renderer.frame_stats().report();
+        uint64_t steady_missed = missed;
+        std::printf("steady: %llu frames, %llu dropped, %.2f fps, scheduler missed %llu\n",
+                    static_cast<unsigned long long>(steady.frames), static_cast<unsigned long long>(steady.dropped),
+                    steady.fps, static_cast<unsigned long long>(steady_missed));
+
+        // One frame well over two budgets long
+        std::this_thread::sleep_for(std::chrono::duration<double>(2.5 / rate_hz));
+        frame(frame_count);
+        frame(frame_count + 1);
+        platform::FrameReport stalled = renderer.frame_stats().report();
+        std::printf("stall: %llu dropped, scheduler missed %llu\n",
+                    static_cast<unsigned long long>(stalled.dropped - steady.dropped),
+                    static_cast<unsigned long long>(missed - steady_missed));
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "Error: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
\ No newline at end of file
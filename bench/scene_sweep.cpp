@@ -0,0 +1,329 @@
+// Scene-scalability sweep. Generates scenes shaped like the demos at sizes
+// from 100 to 1M shapes and records, per size, the build time, heap growth,
+// frame time and X requests per frame, then flags sizes where frame time
+// grows faster than the shape count.
+//
+//   scene_sweep [--backends=headless|xlib|software|all] [--max-shapes=N]
+//               [--scenes=scroll,churn,grid,wireframe] [--min-frames=N]
+//               [--frame-seconds=S] [--csv=path]
+//
+// Scenes:
+//   scroll     flappy-style obstacle pairs, every shape moved each frame
+//   churn      flappy-style pairs addressed by id: moved by id, and a few
+//              removed and respawned with fresh ids every frame
+//   grid       dense point grid as in tests/test.cpp, a few small movers
+//   wireframe  line mesh repainted in full each frame
+#include "bench_common.hpp"
+#include <platform/renderer.hpp>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <malloc.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+
+    // Super-linear if frame time grows with an exponent above this between
+    // adjacent sizes (1.0 is linear; some slack absorbs noise).
+    constexpr double SUPERLINEAR_SLOPE = 1.2;
+    // Too fast to tell scaling from fixed overhead
+    constexpr double MIN_FLAG_MS = 0.05;
+
+    struct Row {
+        std::string scene;
+        std::string backend;
+        size_t shapes;
+        double build_ms;
+        double heap_mb;
+        size_t frames;
+        double frame_ms;      // Median
+        double frame_p95_ms;
+        double requests;      // X requests per frame, 0 when headless
+        double slope;         // log-log frame time growth vs the previous size
+        bool superlinear;
+    };
+
+    size_t heap_bytes() {
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+        return mallinfo2().uordblks;
+#else
+        return 0;
+#endif
+    }
+
+    class Scene {
+    public:
+        virtual ~Scene() = default;
+        virtual void build(platform::Renderer& renderer, size_t shapes) = 0;
+        virtual void frame(platform::Renderer& renderer, size_t index) = 0;
+    };
+
+    class ScrollScene : public Scene {
+    public:
+        void build(platform::Renderer& renderer, size_t shapes) override {
+            renderer.set_draw_color(0, 0, 100, 255);
+            renderer.draw_rect(0, 0, 800, 600, true, 1);
+            renderer.set_draw_color(0, 255, 0, 255);
+            pipes_.clear();
+            for (size_t i = 0; i + 1 < shapes; i += 2) {
+                int x = static_cast<int>(i * 3 % 1600);
+                int gap = 100 + static_cast<int>(i * 37 % 350);
+                pipes_.push_back(Pipe{renderer.draw_rect(x, 0, 50, gap, true), renderer.draw_rect(x, gap + 150, 50, 450 - gap, true), x, gap});
+            }
+        }
+
+        void frame(platform::Renderer& renderer, size_t) override {
+            for (Pipe& pipe : pipes_) {
+                pipe.x = pipe.x <= -50 ? 1550 : pipe.x - 2;
+                renderer.move_shape(pipe.top, pipe.x, 0);
+                renderer.move_shape(pipe.bottom, pipe.x, pipe.gap + 150);
+            }
+        }
+
+    private:
+        struct Pipe {
+            platform::ShapeHandle top, bottom;
+            int x, gap;
+        };
+        std::vector<Pipe> pipes_;
+    };
+
+    class ChurnScene : public Scene {
+    public:
+        void build(platform::Renderer& renderer, size_t shapes) override {
+            renderer.set_draw_color(0, 0, 100, 255);
+            renderer.draw_rect(0, 0, 800, 600, true, 1);
+            renderer.set_draw_color(0, 255, 0, 255);
+            pipes_.clear();
+            next_id_ = FIRST_ID;
+            for (size_t i = 0; i + 1 < shapes; i += 2) {
+                spawn(renderer, static_cast<int>(i * 3 % 1600), 100 + static_cast<int>(i * 37 % 350));
+            }
+        }
+
+        void frame(platform::Renderer& renderer, size_t index) override {
+            for (Pipe& pipe : pipes_) {
+                pipe.x -= 2;
+                renderer.move_shape_by_id(pipe.id, pipe.x, 0);
+                renderer.move_shape_by_id(pipe.id + 1, pipe.x, pipe.gap + 150);
+            }
+            // Oldest pipes leave, new ones arrive, as in tests/flappy.cpp
+            for (size_t i = 0; i < CHURN_PER_FRAME && !pipes_.empty(); ++i) {
+                renderer.remove_shape_by_id(pipes_.front().id);
+                renderer.remove_shape_by_id(pipes_.front().id + 1);
+                pipes_.pop_front();
+                spawn(renderer, 1550, 100 + static_cast<int>((index * 7 + i * 37) % 350));
+            }
+        }
+
+    private:
+        static constexpr int FIRST_ID = 10;
+        static constexpr size_t CHURN_PER_FRAME = 4;
+
+        struct Pipe {
+            int id; // Top; the bottom is id + 1
+            int x, gap;
+        };
+
+        void spawn(platform::Renderer& renderer, int x, int gap) {
+            renderer.draw_rect(x, 0, 50, gap, true, next_id_);
+            renderer.draw_rect(x, gap + 150, 50, 450 - gap, true, next_id_ + 1);
+            pipes_.push_back(Pipe{next_id_, x, gap});
+            next_id_ += 2;
+        }
+
+        std::deque<Pipe> pipes_;
+        int next_id_ = FIRST_ID;
+    };
+
+    class GridScene : public Scene {
+    public:
+        void build(platform::Renderer& renderer, size_t shapes) override {
+            renderer.set_draw_color(0, 0, 100, 255);
+            renderer.draw_rect(0, 0, 800, 600, true, 1);
+            renderer.set_draw_color(255, 255, 255, 255);
+            // Spacing shrinks with size; past one point per pixel they stack
+            int spacing = std::max(1, static_cast<int>(std::sqrt(800.0 * 600.0 / shapes)));
+            int columns = 800 / spacing, rows = 600 / spacing;
+            for (size_t i = 0; i < shapes; ++i) {
+                int cell = static_cast<int>(i % (static_cast<size_t>(columns) * rows));
+                renderer.draw_point(cell % columns * spacing, cell / columns * spacing);
+            }
+            movers_.clear();
+            for (int i = 0; i < 4; ++i) {
+                renderer.set_draw_color(255, static_cast<unsigned char>(60 * i), 0, 255);
+                movers_.push_back(renderer.draw_rect(100 * i, 50 * i, 20 + 5 * i, 20 + 5 * i, true));
+            }
+        }
+
+        void frame(platform::Renderer& renderer, size_t index) override {
+            for (size_t i = 0; i < movers_.size(); ++i) {
+                int t = static_cast<int>(index * (2 + i));
+                renderer.move_shape(movers_[i], t % 760, (t / 2 + 50 * static_cast<int>(i)) % 560);
+            }
+        }
+
+    private:
+        std::vector<platform::ShapeHandle> movers_;
+    };
+
+    class WireframeScene : public Scene {
+    public:
+        void build(platform::Renderer& renderer, size_t shapes) override {
+            renderer.set_draw_color(0, 0, 0, 255);
+            renderer.draw_rect(0, 0, 800, 600, true, 1);
+            renderer.set_draw_color(0, 255, 255, 255);
+            // Triangle-strip mesh over the window
+            int cells = std::max(1, static_cast<int>(std::sqrt(shapes / 3.0)));
+            double sx = 780.0 / cells, sy = 580.0 / cells;
+            for (size_t i = 0; i < shapes; ++i) {
+                size_t cell = i / 3 % (static_cast<size_t>(cells) * cells);
+                int x = 10 + static_cast<int>(cell % cells * sx), y = 10 + static_cast<int>(cell / cells * sy);
+                int dx = static_cast<int>(sx), dy = static_cast<int>(sy);
+                switch (i % 3) {
+                case 0: renderer.draw_line(x, y, x + dx, y); break;
+                case 1: renderer.draw_line(x, y, x, y + dy); break;
+                default: renderer.draw_line(x, y + dy, x + dx, y); break;
+                }
+            }
+        }
+
+        void frame(platform::Renderer& renderer, size_t) override {
+            renderer.invalidate();
+        }
+    };
+
+    std::unique_ptr<Scene> make_scene(const std::string& name) {
+        if (name == "scroll") {
+            return std::make_unique<ScrollScene>();
+        }
+        if (name == "churn") {
+            return std::make_unique<ChurnScene>();
+        }
+        if (name == "grid") {
+            return std::make_unique<GridScene>();
+        }
+        if (name == "wireframe") {
+            return std::make_unique<WireframeScene>();
+        }
+        return nullptr;
+    }
+
+    Row run(const std::string& scene_name, const bench::BackendChoice& backend, size_t shapes, size_t min_frames,
+            double frame_seconds) {
+        platform::WindowConfig config;
+        config.title = "scene_sweep";
+        config.width = 800;
+        config.height = 600;
+        config.backend = backend.x11 ? platform::Backend::X11 : platform::Backend::HEADLESS;
+        platform::Window window(config);
+        Display* dpy = window.get_display();
+        auto sync = [dpy] {
+            if (dpy) {
+                XSync(dpy, False);
+            }
+        };
+
+        size_t heap_before = heap_bytes();
+        bench::Clock::time_point start = bench::Clock::now();
+        std::unique_ptr<Scene> scene = make_scene(scene_name);
+        platform::Renderer renderer(window, backend.software ? platform::RenderMode::SOFTWARE : platform::RenderMode::XLIB);
+        window.show();
+        scene->build(renderer, shapes);
+        renderer.present();
+        sync();
+        Row row{scene_name, backend.name, shapes, bench::seconds_since(start) * 1e3, 0, 0, 0, 0, 0, 0, false};
+        size_t heap_after = heap_bytes();
+        row.heap_mb = heap_after > heap_before ? (heap_after - heap_before) / (1024.0 * 1024.0) : 0.0;
+
+        std::vector<double> frames;
+        unsigned long requests = 0;
+        bench::Clock::time_point sweep_start = bench::Clock::now();
+        while (frames.size() < min_frames || bench::seconds_since(sweep_start) < frame_seconds) {
+            unsigned long first_request = dpy ? NextRequest(dpy) : 0;
+            bench::Clock::time_point frame_start = bench::Clock::now();
+            scene->frame(renderer, frames.size());
+            renderer.present();
+            sync();
+            frames.push_back(bench::seconds_since(frame_start) * 1e3);
+            // Minus the XSync round trip the benchmark adds
+            requests += dpy ? NextRequest(dpy) - first_request - 1 : 0;
+        }
+        bench::Summary summary = bench::summarize(frames);
+        row.frames = frames.size();
+        row.frame_ms = summary.median;
+        row.frame_p95_ms = summary.p95;
+        row.requests = static_cast<double>(requests) / frames.size();
+        return row;
+    }
+
+    std::string to_csv(const std::vector<Row>& rows) {
+        std::string out = "scene,backend,shapes,build_ms,heap_mb,frames,frame_ms,frame_p95_ms,requests_per_frame,slope,superlinear\n";
+        char line[256];
+        for (const Row& r : rows) {
+            std::snprintf(line, sizeof(line), "%s,%s,%zu,%.3f,%.3f,%zu,%.4f,%.4f,%.1f,%.3f,%d\n", r.scene.c_str(),
+                          r.backend.c_str(), r.shapes, r.build_ms, r.heap_mb, r.frames, r.frame_ms, r.frame_p95_ms,
+                          r.requests, r.slope, r.superlinear ? 1 : 0);
+            out += line;
+        }
+        return out;
+    }
+
+} // namespace
+
+int main(int argc, char** argv) {
+    try {
+        size_t max_shapes = std::stoul(bench::option(argc, argv, "max-shapes", "1000000"));
+        size_t min_frames = std::stoul(bench::option(argc, argv, "min-frames", "5"));
+        double frame_seconds = std::stod(bench::option(argc, argv, "frame-seconds", "0.5"));
+        std::string scenes = bench::option(argc, argv, "scenes", "scroll,churn,grid,wireframe");
+        std::vector<bench::BackendChoice> backends = bench::parse_backends(bench::option(argc, argv, "backends", "headless"));
+
+        std::printf("%-10s %-9s %8s %10s %9s %7s %10s %10s %10s %6s\n", "scene", "backend", "shapes", "build ms",
+                    "heap MB", "frames", "frame ms", "p95 ms", "req/frame", "slope");
+        std::vector<Row> rows;
+        int flagged = 0;
+        for (const bench::BackendChoice& backend : backends) {
+            size_t begin = 0;
+            for (size_t end = scenes.find(','); begin != std::string::npos;
+                 begin = end == std::string::npos ? end : end + 1, end = scenes.find(',', begin)) {
+                std::string scene = scenes.substr(begin, end == std::string::npos ? std::string::npos : end - begin);
+                if (!make_scene(scene)) {
+                    std::fprintf(stderr, "Unknown scene %s\n", scene.c_str());
+                    return 1;
+                }
+                // An index, not a pointer: push_back may move the rows
+                size_t previous = rows.size();
+                for (size_t shapes = 100; shapes <= max_shapes; shapes *= 10) {
+                    rows.push_back(run(scene, backend, shapes, min_frames, frame_seconds));
+                    Row& row = rows.back();
+                    if (previous + 1 < rows.size() && rows[previous].frame_ms > 0 && row.frame_ms > 0) {
+                        const Row& before = rows[previous];
+                        row.slope = std::log(row.frame_ms / before.frame_ms) / std::log(double(row.shapes) / before.shapes);
+                        row.superlinear = row.slope > SUPERLINEAR_SLOPE && row.frame_ms > MIN_FLAG_MS;
+                        flagged += row.superlinear;
+                    }
+                    std::printf("%-10s %-9s %8zu %10.2f %9.2f %7zu %10.4f %10.4f %10.1f %6.2f%s\n", row.scene.c_str(),
+                                row.backend.c_str(), row.shapes, row.build_ms, row.heap_mb, row.frames, row.frame_ms,
+                                row.frame_p95_ms, row.requests, row.slope, row.superlinear ? "  SUPER-LINEAR" : "");
+                    std::fflush(stdout);
+                    previous = rows.size() - 1;
+                }
+            }
+        }
+        if (flagged) {
+            std::printf("%d size step(s) scale worse than O(n^%.1f)\n", flagged, SUPERLINEAR_SLOPE);
+        }
+
+        std::string csv = bench::option(argc, argv, "csv", "");
+        if (!csv.empty() && !bench::write_file(csv, to_csv(rows))) {
+            return 1;
+        }
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "Error: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -1,8 +1,13 @@
 #include <pybind11/pybind11.h>
 #include <pybind11/stl.h>
+#include <pybind11/operators.h>
 #include "../source/platform/window.hpp"
 #include "../source/platform/event.hpp"
 #include "../source/platform/renderer.hpp"
+#include "../source/platform/profiler.hpp"
+#include "../source/platform/x_traffic.hpp"
+#include "../source/platform/frame_scheduler.hpp"
+#include "../source/platform/fixed_timestep.hpp"
 
 namespace py = pybind11;
 
@@ -15,6 +20,13 @@ PYBIND11_MODULE(platform_engine, m) {
         .value("CLOSE", platform::State::CLOSE)
         .export_values();
 
+    // Backend enum
+    py::enum_<platform::Backend>(m, "Backend")
+        .value("X11", platform::Backend::X11)
+        .value("XCB", platform::Backend::XCB)
+        .value("HEADLESS", platform::Backend::HEADLESS)
+        .export_values();
+
     // WindowConfig
     py::class_<platform::WindowConfig>(m, "WindowConfig")
         .def(py::init([](const std::string& title, int x, int y, int width, int height) {
@@ -31,7 +43,8 @@ PYBIND11_MODULE(platform_engine, m) {
         .def_readwrite("y", &platform::WindowConfig::y)
         .def_readwrite("width", &platform::WindowConfig::width)
         .def_readwrite("height", &platform::WindowConfig::height)
-        .def_readwrite("background_color", &platform::WindowConfig::background_color);
+        .def_readwrite("background_color", &platform::WindowConfig::background_color)
+        .def_readwrite("backend", &platform::WindowConfig::backend);
 
     // Color
     py::class_<platform::Color>(m, "Color")
@@ -41,40 +54,24 @@ PYBIND11_MODULE(platform_engine, m) {
         .def_readwrite("b", &platform::Color::b)
         .def_readwrite("a", &platform::Color::a);
 
-    // Point
-    py::class_<platform::Point>(m, "Point")
-        .def(py::init<int, int, platform::Color, int>())
-        .def_readwrite("x", &platform::Point::x)
-        .def_readwrite("y", &platform::Point::y)
-        .def_readwrite("color", &platform::Point::color)
-        .def_readwrite("id", &platform::Point::id);
-
-    // Line
-    py::class_<platform::Line>(m, "Line")
-        .def(py::init<int, int, int, int, platform::Color, int>())
-        .def_readwrite("x1", &platform::Line::x1)
-        .def_readwrite("y1", &platform::Line::y1)
-        .def_readwrite("x2", &platform::Line::x2)
-        .def_readwrite("y2", &platform::Line::y2)
-        .def_readwrite("color", &platform::Line::color)
-        .def_readwrite("id", &platform::Line::id);
-
-    // Rectangle
-    py::class_<platform::Rectangle>(m, "Rectangle")
-        .def(py::init<int, int, int, int, platform::Color, bool, int>())
-        .def_readwrite("x", &platform::Rectangle::x)
-        .def_readwrite("y", &platform::Rectangle::y)
-        .def_readwrite("width", &platform::Rectangle::width)
-        .def_readwrite("height", &platform::Rectangle::height)
-        .def_readwrite("color", &platform::Rectangle::color)
-        .def_readwrite("filled", &platform::Rectangle::filled)
-        .def_readwrite("id", &platform::Rectangle::id);
+    // ShapeHandle
+    py::class_<platform::ShapeHandle>(m, "ShapeHandle")
+        .def(py::init<>())
+        .def_readonly("index", &platform::ShapeHandle::index)
+        .def_readonly("generation", &platform::ShapeHandle::generation)
+        .def("valid", &platform::ShapeHandle::valid)
+        .def(py::self == py::self)
+        .def(py::self != py::self);
 
     // Window
     py::class_<platform::Window>(m, "Window")
         .def(py::init<platform::WindowConfig>())
         .def("show", &platform::Window::show)
-        .def("should_run", &platform::Window::should_run);
+        .def("should_run", &platform::Window::should_run)
+        .def("close", &platform::Window::close)
+        .def("is_headless", &platform::Window::is_headless)
+        .def("is_xcb", &platform::Window::is_xcb)
+        .def("shown", &platform::Window::shown);
 
     // EventKind enum
     py::enum_<platform::EventKind>(m, "EventKind")
@@ -83,22 +80,242 @@ PYBIND11_MODULE(platform_engine, m) {
         .value("KEY_SPACE", platform::EventKind::KEY_SPACE)
         .value("KEY_ESC", platform::EventKind::KEY_ESC)
         .value("EXIT", platform::EventKind::EXIT)
+        .value("LEFT_CLICK", platform::EventKind::LEFT_CLICK)
+        .value("RIGHT_CLICK", platform::EventKind::RIGHT_CLICK)
+        .value("MIDDLE_CLICK", platform::EventKind::MIDDLE_CLICK)
+        .value("KEY_A", platform::EventKind::KEY_A)
+        .value("KEY_UP", platform::EventKind::KEY_UP)
+        .value("KEY_DOWN", platform::EventKind::KEY_DOWN)
+        .value("KEY_LEFT", platform::EventKind::KEY_LEFT)
+        .value("KEY_RIGHT", platform::EventKind::KEY_RIGHT)
         .export_values();
 
+    // Input snapshot
+    py::enum_<platform::Key> key(m, "Key");
+    const char* letters[] = {"A", "B", "C", "D", "E", "F", "G", "H", "I", "J", "K", "L", "M",
+                             "N", "O", "P", "Q", "R", "S", "T", "U", "V", "W", "X", "Y", "Z"};
+    for (int i = 0; i < 26; ++i) {
+        key.value(letters[i], static_cast<platform::Key>(static_cast<int>(platform::Key::A) + i));
+    }
+    key.value("UNKNOWN", platform::Key::UNKNOWN)
+        .value("SPACE", platform::Key::SPACE)
+        .value("ESCAPE", platform::Key::ESCAPE)
+        .value("ENTER", platform::Key::ENTER)
+        .value("TAB", platform::Key::TAB)
+        .value("BACKSPACE", platform::Key::BACKSPACE)
+        .value("UP", platform::Key::UP)
+        .value("DOWN", platform::Key::DOWN)
+        .value("LEFT", platform::Key::LEFT)
+        .value("RIGHT", platform::Key::RIGHT)
+        .value("LEFT_SHIFT", platform::Key::LEFT_SHIFT)
+        .value("LEFT_CTRL", platform::Key::LEFT_CTRL);
+
+    py::enum_<platform::MouseButton>(m, "MouseButton")
+        .value("LEFT", platform::MouseButton::LEFT)
+        .value("MIDDLE", platform::MouseButton::MIDDLE)
+        .value("RIGHT", platform::MouseButton::RIGHT);
+
+    py::class_<platform::MouseState>(m, "MouseState")
+        .def_readonly("x", &platform::MouseState::x)
+        .def_readonly("y", &platform::MouseState::y)
+        .def_readonly("wheel", &platform::MouseState::wheel)
+        .def("down", &platform::MouseState::down)
+        .def("pressed", [](const platform::MouseState& mouse, platform::MouseButton button) {
+            return (mouse.pressed & platform::MouseState::bit(button)) != 0;
+        });
+
+    py::class_<platform::InputSnapshot>(m, "InputSnapshot")
+        .def_readonly("frame", &platform::InputSnapshot::frame)
+        .def_readonly("mouse", &platform::InputSnapshot::mouse)
+        .def_readonly("focused", &platform::InputSnapshot::focused)
+        .def_readonly("close_requested", &platform::InputSnapshot::close_requested)
+        .def("down", &platform::InputSnapshot::down)
+        .def("pressed", &platform::InputSnapshot::pressed)
+        .def("released", &platform::InputSnapshot::released);
+
     // Event
     py::class_<platform::Event>(m, "Event")
-        .def(py::init<const platform::Window&>())
+        .def(py::init<const platform::Window&, bool>(), py::arg("window"), py::arg("input_thread") = false)
         .def("poll", &platform::Event::poll, py::arg("renderer"))
-        .def("kind", &platform::Event::kind);
+        .def("inject", &platform::Event::inject, py::arg("kind"), py::arg("x") = 0, py::arg("y") = 0)
+        .def("kind", &platform::Event::kind)
+        .def("x", &platform::Event::x)
+        .def("y", &platform::Event::y)
+        .def("pump", &platform::Event::pump, py::arg("renderer"))
+        .def("capture", &platform::Event::capture, py::arg("renderer"), py::return_value_policy::reference_internal)
+        .def("input", &platform::Event::input, py::return_value_policy::reference_internal)
+        .def("threaded", &platform::Event::threaded)
+        .def("wake_fd", &platform::Event::wake_fd)
+        .def("dropped", &platform::Event::dropped);
+
+    // Frame statistics
+    py::enum_<platform::FramePhase>(m, "FramePhase")
+        .value("POLL", platform::FramePhase::POLL)
+        .value("UPDATE", platform::FramePhase::UPDATE)
+        .value("BUILD", platform::FramePhase::BUILD)
+        .value("SUBMIT", platform::FramePhase::SUBMIT)
+        .value("FLUSH", platform::FramePhase::FLUSH)
+        .value("FRAME", platform::FramePhase::FRAME)
+        .export_values();
+
+    py::class_<platform::PhaseReport>(m, "PhaseReport")
+        .def_readonly("phase", &platform::PhaseReport::phase)
+        .def_readonly("count", &platform::PhaseReport::count)
+        .def_readonly("mean_ms", &platform::PhaseReport::mean_ms)
+        .def_readonly("p50_ms", &platform::PhaseReport::p50_ms)
+        .def_readonly("p95_ms", &platform::PhaseReport::p95_ms)
+        .def_readonly("p99_ms", &platform::PhaseReport::p99_ms)
+        .def_readonly("max_ms", &platform::PhaseReport::max_ms);
+
+    py::class_<platform::FrameReport>(m, "FrameReport")
+        .def_readonly("timestamp_s", &platform::FrameReport::timestamp_s)
+        .def_readonly("elapsed_s", &platform::FrameReport::elapsed_s)
+        .def_readonly("frames", &platform::FrameReport::frames)
+        .def_readonly("dropped", &platform::FrameReport::dropped)
+        .def_readonly("budget_ms", &platform::FrameReport::budget_ms)
+        .def_readonly("fps", &platform::FrameReport::fps)
+        .def_readonly("phases", &platform::FrameReport::phases)
+        .def_readonly("input_latency", &platform::FrameReport::input_latency)
+        .def("to_csv", [](const platform::FrameReport& report) { return platform::FrameStats::to_csv(report); })
+        .def("to_json", &platform::FrameStats::to_json);
+
+    py::class_<platform::FrameStats>(m, "FrameStats")
+        .def("add", [](platform::FrameStats& stats, platform::FramePhase phase, double ms) {
+            stats.add(phase, static_cast<uint64_t>(ms * 1e6));
+        })
+        .def("report", py::overload_cast<>(&platform::FrameStats::report, py::const_))
+        .def("reset", &platform::FrameStats::reset)
+        .def("set_budget_ms", &platform::FrameStats::set_budget_ms)
+        .def("budget_ms", &platform::FrameStats::budget_ms)
+        .def("set_auto_dump", &platform::FrameStats::set_auto_dump, py::arg("path"), py::arg("interval_s") = 5.0)
+        .def("write_csv", &platform::FrameStats::write_csv)
+        .def("write_json", &platform::FrameStats::write_json);
+
+    // X request accounting
+    py::class_<platform::XTrafficCounters>(m, "XTrafficCounters")
+        .def_readonly("calls", &platform::XTrafficCounters::calls)
+        .def_readonly("requests", &platform::XTrafficCounters::requests)
+        .def_readonly("bytes", &platform::XTrafficCounters::bytes)
+        .def_readonly("flushes", &platform::XTrafficCounters::flushes)
+        .def_readonly("round_trips", &platform::XTrafficCounters::round_trips)
+        .def_property_readonly("blocked_ms", [](const platform::XTrafficCounters& c) { return c.blocked_ns / 1e6; });
+
+    py::class_<platform::XTrafficSite>(m, "XTrafficSite")
+        .def_readonly("site", &platform::XTrafficSite::site)
+        .def_readonly("total", &platform::XTrafficSite::total)
+        .def_readonly("frames", &platform::XTrafficSite::frames)
+        .def_readonly("max_frame_requests", &platform::XTrafficSite::max_frame_requests)
+        .def_readonly("max_frame_round_trips", &platform::XTrafficSite::max_frame_round_trips);
+
+    py::class_<platform::XTrafficReport>(m, "XTrafficReport")
+        .def_readonly("frames", &platform::XTrafficReport::frames)
+        .def_readonly("total", &platform::XTrafficReport::total)
+        .def_readonly("last_frame", &platform::XTrafficReport::last_frame)
+        .def_readonly("max_frame", &platform::XTrafficReport::max_frame)
+        .def_readonly("sites", &platform::XTrafficReport::sites)
+        .def("to_csv", &platform::x_traffic_to_csv)
+        .def("to_json", &platform::x_traffic_to_json);
+    m.def("x_traffic_report", &platform::x_traffic_report);
+    m.def("x_traffic_reset", &platform::x_traffic_reset);
+    m.def("x_traffic_write", &platform::x_traffic_write);
+
+    // Profiler zones: `with platform_engine.Zone("name"):`
+    struct PyZone {
+        const char* name;
+        uint64_t start;
+    };
+    py::class_<PyZone>(m, "Zone")
+        .def(py::init([](const std::string& name) { return PyZone{platform::profiler_intern(name), 0}; }))
+        .def("__enter__", [](PyZone& zone) {
+            zone.start = platform::profiler_now();
+            return &zone;
+        }, py::return_value_policy::reference)
+        .def("__exit__", [](PyZone& zone, py::object, py::object, py::object) {
+            platform::profiler_record(zone.name, zone.start, platform::profiler_now());
+            return false;
+        });
+    m.def("profiler_enabled", &platform::profiler_enabled);
+    m.def("profiler_write", &platform::profiler_write);
+    m.def("profiler_set_thread_name", &platform::profiler_set_thread_name);
+
+    // Frame scheduler
+    py::enum_<platform::WakeReason>(m, "WakeReason")
+        .value("FRAME", platform::WakeReason::FRAME)
+        .value("INPUT", platform::WakeReason::INPUT)
+        .export_values();
+
+    py::class_<platform::FrameScheduler>(m, "FrameScheduler")
+        .def(py::init<const platform::Window&, double>(), py::arg("window"), py::arg("rate_hz") = 60.0)
+        .def("set_rate", &platform::FrameScheduler::set_rate)
+        .def("rate", &platform::FrameScheduler::rate)
+        .def("wait", &platform::FrameScheduler::wait, py::arg("idle") = false,
+             py::call_guard<py::gil_scoped_release>())
+        .def("missed", &platform::FrameScheduler::missed)
+        .def("watch", &platform::FrameScheduler::watch);
+
+    // Fixed-step simulation clock
+    py::class_<platform::FixedTimestep>(m, "FixedTimestep")
+        .def(py::init<double, int>(), py::arg("rate_hz") = 120.0, py::arg("max_steps") = 8)
+        .def("set_rate", &platform::FixedTimestep::set_rate)
+        .def("rate", &platform::FixedTimestep::rate)
+        .def("step", &platform::FixedTimestep::step)
+        .def("set_max_steps", &platform::FixedTimestep::set_max_steps)
+        .def("max_steps", &platform::FixedTimestep::max_steps)
+        .def("advance", &platform::FixedTimestep::advance)
+        .def("alpha", &platform::FixedTimestep::alpha)
+        .def("dropped_steps", &platform::FixedTimestep::dropped_steps)
+        .def("reset", &platform::FixedTimestep::reset);
+
+    // RenderMode enum
+    py::enum_<platform::RenderMode>(m, "RenderMode")
+        .value("XLIB", platform::RenderMode::XLIB)
+        .value("SOFTWARE", platform::RenderMode::SOFTWARE)
+        .export_values();
 
     // Renderer
+    py::class_<platform::StartupReport>(m, "StartupReport")
+        .def_readonly("process_ms", &platform::StartupReport::process_ms)
+        .def_readonly("configure_ms", &platform::StartupReport::configure_ms)
+        .def_readonly("first_frame_ms", &platform::StartupReport::first_frame_ms)
+        .def_readonly("total_ms", &platform::StartupReport::total_ms);
+
     py::class_<platform::Renderer>(m, "Renderer")
         .def(py::init<const platform::Window&>())
+        .def(py::init<const platform::Window&, platform::RenderMode>())
         .def("set_draw_color", &platform::Renderer::set_draw_color)
         .def("clear", &platform::Renderer::clear)
         .def("draw_point", &platform::Renderer::draw_point)
         .def("draw_line", &platform::Renderer::draw_line)
         .def("draw_rect", &platform::Renderer::draw_rect)
         .def("remove_shape_by_id", &platform::Renderer::remove_shape_by_id)
-        .def("present", &platform::Renderer::present);
+        .def("remove_shape", &platform::Renderer::remove_shape)
+        .def("contains", &platform::Renderer::contains)
+        .def("shape_count", &platform::Renderer::shape_count)
+        .def("move_shape", &platform::Renderer::move_shape)
+        .def("resize_shape", &platform::Renderer::resize_shape)
+        .def("set_shape_color", &platform::Renderer::set_shape_color)
+        .def("set_shape_visible", &platform::Renderer::set_shape_visible)
+        .def("move_shape_by_id", &platform::Renderer::move_shape_by_id)
+        .def("resize_shape_by_id", &platform::Renderer::resize_shape_by_id)
+        .def("set_shape_color_by_id", &platform::Renderer::set_shape_color_by_id)
+        .def("set_shape_visible_by_id", &platform::Renderer::set_shape_visible_by_id)
+        .def("dirty", &platform::Renderer::dirty)
+        .def("invalidate", py::overload_cast<>(&platform::Renderer::invalidate))
+        .def("mode", &platform::Renderer::mode)
+        .def("frame_stats", py::overload_cast<>(&platform::Renderer::frame_stats), py::return_value_policy::reference_internal)
+        .def("startup", &platform::Renderer::startup)
+        .def("set_thread_count", &platform::Renderer::set_thread_count)
+        .def("thread_count", &platform::Renderer::thread_count)
+        .def("set_confirm_present", &platform::Renderer::set_confirm_present)
+        .def("confirm_present", &platform::Renderer::confirm_present)
+        .def("read_pixels", &platform::Renderer::read_pixels)
+        .def("read_pixel", &platform::Renderer::read_pixel)
+        .def("width", &platform::Renderer::width)
+        .def("height", &platform::Renderer::height)
+        .def("resize", &platform::Renderer::resize)
+        .def("buffer_width", &platform::Renderer::buffer_width)
+        .def("buffer_height", &platform::Renderer::buffer_height)
+        .def("present", &platform::Renderer::present)
+        .def("idle", &platform::Renderer::idle)
+        .def("scene_generation", &platform::Renderer::scene_generation);
 }
\ No newline at end of file
@@ -14,6 +14,10 @@ def main():
         # Create event handler
         event = platform_engine.Event(window)
 
+        # Wakes on input or every 1/60 s instead of sleep-polling
+        scheduler = platform_engine.FrameScheduler(window, 60.0)
+        scheduler.watch(event.wake_fd())  # ENGINE_INPUT_THREAD=1
+
         # Draw blue background
         blue = platform_engine.Color(0, 0, 100, 255)
         renderer.set_draw_color(blue.r, blue.g, blue.b, blue.a)
@@ -24,12 +28,17 @@ def main():
         rect_id = 2
         rect_x = 200
         rect_velocity = 100.0  # Pixels/sec
+        renderer.set_draw_color(red.r, red.g, red.b, red.a)
+        rect = renderer.draw_rect(int(rect_x), 300, 50, 50, True, rect_id)
 
         running = True
+        update_zone = platform_engine.Zone("main.py update")
         last_time = time.time()
 
         # Main loop
         while running and window.should_run() == platform_engine.State.RUNNING:
+            frame_due = scheduler.wait() == platform_engine.WakeReason.FRAME
+
             # Handle events
             while event.poll(renderer):
                 kind = event.kind()
@@ -37,27 +46,25 @@ def main():
                     running = False
                 elif kind == platform_engine.EventKind.KEY_SPACE:
                     rect_velocity = -rect_velocity  # Reverse direction
+            if not frame_due or not running:
+                continue
 
-            # Update
-            current_time = time.time()
-            delta_time = current_time - last_time
-            last_time = current_time
+            # Update (shows up as its own zone in profiler traces)
+            with update_zone:
+                current_time = time.time()
+                delta_time = current_time - last_time
+                last_time = current_time
 
-            # Update rectangle position
-            renderer.remove_shape_by_id(rect_id)
-            rect_x += rect_velocity * delta_time
-            if rect_x <= 0 or rect_x + 50 >= 800:
-                rect_velocity = -rect_velocity
-                rect_x = max(0, min(rect_x, 750))
-            renderer.set_draw_color(red.r, red.g, red.b, red.a)
-            renderer.draw_rect(int(rect_x), 300, 50, 50, True, rect_id)
+                # Update rectangle position
+                rect_x += rect_velocity * delta_time
+                if rect_x <= 0 or rect_x + 50 >= 800:
+                    rect_velocity = -rect_velocity
+                    rect_x = max(0, min(rect_x, 750))
+                renderer.move_shape(rect, int(rect_x), 300)
 
             # Render
             renderer.present()
 
-            # Cap frame rate
-            time.sleep(0.002)
-
     except Exception as e:
         print(f"Error: {e}")
     finally:
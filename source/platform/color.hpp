@@ -0,0 +1,58 @@
+#ifndef PLATFORM_COLOR_HPP
+#define PLATFORM_COLOR_HPP
+
+#include "window.hpp"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace platform {
+
+    struct Color {
+        unsigned char r, g, b, a;
+        unsigned long x11_color;
+    };
+
+    // Maps RGB triples to pixel values for a display's default visual.
+    // Without a display (headless) pixels are 0x00RRGGBB.
+    // TrueColor and DirectColor pixels are composed from the visual's channel
+    // masks without talking to the server. Other visuals fall back to
+    // XAllocColor, cached per RGB value; the cached cells are released when
+    // the resolver is destroyed.
+    class ColorResolver {
+    public:
+        explicit ColorResolver(Display* dpy);
+        ~ColorResolver();
+        ColorResolver(const ColorResolver&) = delete;
+        ColorResolver& operator=(const ColorResolver&) = delete;
+
+        unsigned long resolve(unsigned char r, unsigned char g, unsigned char b);
+        bool direct() const { return direct_; }
+
+    private:
+        struct Channel {
+            int shift = 0;
+            int bits = 0;
+            unsigned long compose(unsigned char value) const {
+                // Wider channels replicate the high bits so 255 maps to full intensity
+                unsigned long v = bits > 8 ? (static_cast<unsigned long>(value) << (bits - 8)) | (value >> (16 - bits))
+                                           : (static_cast<unsigned long>(value) >> (8 - bits));
+                return v << shift;
+            }
+        };
+
+        static Channel channel_from_mask(unsigned long mask);
+        unsigned long allocate(unsigned char r, unsigned char g, unsigned char b);
+
+        Display* dpy_;
+        Colormap cmap_;
+        unsigned long fallback_;
+        bool direct_;
+        Channel red_, green_, blue_;
+        std::unordered_map<uint32_t, unsigned long> cache_;
+        std::vector<unsigned long> allocated_;
+    };
+
+} // namespace platform
+
+#endif // PLATFORM_COLOR_HPP
@@ -0,0 +1,84 @@
+#include "color.hpp"
+#include "log.hpp"
+#include "x_traffic.hpp"
+#include <X11/Xutil.h>
+
+namespace platform {
+
+ColorResolver::ColorResolver(Display* dpy)
+    : dpy_(dpy),
+      cmap_(0),
+      fallback_(0xffffff),
+      direct_(false) {
+    if (!dpy_) {
+        red_ = channel_from_mask(0xff0000);
+        green_ = channel_from_mask(0x00ff00);
+        blue_ = channel_from_mask(0x0000ff);
+        direct_ = true;
+        return;
+    }
+    int screen = DefaultScreen(dpy_);
+    cmap_ = DefaultColormap(dpy_, screen);
+    fallback_ = WhitePixel(dpy_, screen);
+    Visual* visual = DefaultVisual(dpy_, screen);
+    if (visual->c_class == TrueColor || visual->c_class == DirectColor) {
+        red_ = channel_from_mask(visual->red_mask);
+        green_ = channel_from_mask(visual->green_mask);
+        blue_ = channel_from_mask(visual->blue_mask);
+        direct_ = red_.bits > 0 && green_.bits > 0 && blue_.bits > 0;
+    }
+}
+
+ColorResolver::~ColorResolver() {
+    if (!allocated_.empty()) {
+        XFreeColors(dpy_, cmap_, allocated_.data(), static_cast<int>(allocated_.size()), 0);
+    }
+}
+
+ColorResolver::Channel ColorResolver::channel_from_mask(unsigned long mask) {
+    Channel channel;
+    if (!mask) {
+        return channel;
+    }
+    while (!(mask & 1)) {
+        mask >>= 1;
+        channel.shift++;
+    }
+    while (mask & 1) {
+        mask >>= 1;
+        channel.bits++;
+    }
+    return channel;
+}
+
+unsigned long ColorResolver::resolve(unsigned char r, unsigned char g, unsigned char b) {
+    if (direct_) {
+        return red_.compose(r) | green_.compose(g) | blue_.compose(b);
+    }
+    uint32_t key = (static_cast<uint32_t>(r) << 16) | (static_cast<uint32_t>(g) << 8) | b;
+    auto it = cache_.find(key);
+    if (it != cache_.end()) {
+        return it->second;
+    }
+    unsigned long pixel = allocate(r, g, b);
+    cache_.emplace(key, pixel);
+    return pixel;
+}
+
+unsigned long ColorResolver::allocate(unsigned char r, unsigned char g, unsigned char b) {
+    XColor xcolor;
+    xcolor.red = r << 8;
+    xcolor.green = g << 8;
+    xcolor.blue = b << 8;
+    xcolor.flags = DoRed | DoGreen | DoBlue;
+    ENGINE_X_CALL(dpy_, "ColorResolver::allocate XAllocColor");
+    if (XAllocColor(dpy_, cmap_, &xcolor)) {
+        allocated_.push_back(xcolor.pixel);
+        ENGINE_LOG_DEBUG("Allocated color RGB({},{},{}) = {}", r, g, b, xcolor.pixel);
+        return xcolor.pixel;
+    }
+    ENGINE_LOG_WARN("Failed to allocate color RGB({},{},{})", r, g, b);
+    return fallback_;
+}
+
+} // namespace platform
@@ -0,0 +1,49 @@
+#include "damage.hpp"
+
+namespace platform {
+
+void DamageRegion::add(const Bounds& bounds) {
+    if (full_ || bounds.empty()) {
+        return;
+    }
+    Bounds merged = bounds;
+    // Absorb everything the new rect touches; growing it may make it touch
+    // rects that were skipped earlier, so rescan until nothing changes.
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 0; i < rects_.size(); ++i) {
+            if (rects_[i].intersects(merged)) {
+                merged.merge(rects_[i]);
+                rects_[i] = rects_.back();
+                rects_.pop_back();
+                changed = true;
+                break;
+            }
+        }
+    }
+    rects_.push_back(merged);
+    while (rects_.size() > max_rects_) {
+        merge_cheapest_pair();
+    }
+}
+
+void DamageRegion::merge_cheapest_pair() {
+    size_t best_a = 0, best_b = 1;
+    long best_waste = -1;
+    for (size_t a = 0; a < rects_.size(); ++a) {
+        for (size_t b = a + 1; b < rects_.size(); ++b) {
+            long waste = rects_[a].united(rects_[b]).area() - rects_[a].area() - rects_[b].area();
+            if (best_waste < 0 || waste < best_waste) {
+                best_waste = waste;
+                best_a = a;
+                best_b = b;
+            }
+        }
+    }
+    rects_[best_a].merge(rects_[best_b]);
+    rects_[best_b] = rects_.back();
+    rects_.pop_back();
+}
+
+} // namespace platform
@@ -0,0 +1,38 @@
+#ifndef PLATFORM_DAMAGE_HPP
+#define PLATFORM_DAMAGE_HPP
+
+#include "geometry.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace platform {
+
+    // Screen areas that must be repainted on the next present. Overlapping
+    // additions are merged, and when more than max_rects remain the pair
+    // whose union wastes the least area is merged, so present only ever has
+    // a handful of rectangles to clip and copy.
+    class DamageRegion {
+    public:
+        explicit DamageRegion(size_t max_rects = 16) : max_rects_(max_rects) {}
+
+        void add(const Bounds& bounds);
+        // Damages everything; cheaper than adding a rect covering the target.
+        void add_all() { full_ = true; rects_.clear(); }
+        void clear() { full_ = false; rects_.clear(); }
+
+        bool empty() const { return !full_ && rects_.empty(); }
+        bool full() const { return full_; }
+        // Only meaningful when !full()
+        const std::vector<Bounds>& rects() const { return rects_; }
+
+    private:
+        void merge_cheapest_pair();
+
+        size_t max_rects_;
+        bool full_ = false;
+        std::vector<Bounds> rects_;
+    };
+
+} // namespace platform
+
+#endif // PLATFORM_DAMAGE_HPP
@@ -0,0 +1,55 @@
+#ifndef PLATFORM_DRAW_BATCH_HPP
+#define PLATFORM_DRAW_BATCH_HPP
+
+#include "window.hpp"
+#include "geometry.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace platform {
+
+    enum class BatchKind {
+        POINTS,
+        SEGMENTS,
+        FILL_RECTS,
+        OUTLINE_RECTS
+    };
+
+    // Collects primitives for one frame and submits them as poly requests
+    // (XDrawPoints, XDrawSegments, XFillRectangles, XDrawRectangles), one
+    // per (kind, pixel) batch. A primitive may join an earlier batch with the
+    // same state only if it does not overlap anything queued after that
+    // batch, so the result matches drawing the primitives in order.
+    class DrawBatcher {
+    public:
+        void begin();
+        void add_point(int x, int y, unsigned long pixel);
+        void add_line(int x1, int y1, int x2, int y2, unsigned long pixel);
+        void add_rect(int x, int y, int width, int height, bool filled, unsigned long pixel);
+        // Returns the number of X requests issued.
+        size_t submit(Display* dpy, Drawable target, GC gc);
+
+        size_t batch_count() const { return used_; }
+
+    private:
+        // How many trailing batches a primitive may be merged across
+        static constexpr size_t LOOKBACK = 16;
+
+        struct Batch {
+            BatchKind kind;
+            unsigned long pixel;
+            Bounds bounds;
+            std::vector<XPoint> points;
+            std::vector<XSegment> segments;
+            std::vector<XRectangle> rects;
+        };
+
+        Batch& batch_for(BatchKind kind, unsigned long pixel, const Bounds& bounds);
+
+        std::vector<Batch> batches_; // Reused across frames; only the first used_ are live
+        size_t used_ = 0;
+    };
+
+} // namespace platform
+
+#endif // PLATFORM_DRAW_BATCH_HPP
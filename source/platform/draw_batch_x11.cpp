@@ -0,0 +1,141 @@
+#include "draw_batch.hpp"
+#include "x_traffic.hpp"
+#include <algorithm>
+#include <climits>
+
+namespace platform {
+
+namespace {
+
+    short clamp_coord(int v) {
+        return static_cast<short>(std::clamp(v, SHRT_MIN, SHRT_MAX));
+    }
+
+    unsigned short clamp_extent(int v) {
+        return static_cast<unsigned short>(std::clamp(v, 0, USHRT_MAX));
+    }
+
+    // Largest number of items of the given wire size (in 4-byte units) that
+    // fit in one request after the 3-unit poly request header.
+    size_t items_per_request(Display* dpy, size_t units_per_item) {
+        long max_units = XMaxRequestSize(dpy);
+        return static_cast<size_t>(std::max(1L, (max_units - 3) / static_cast<long>(units_per_item)));
+    }
+
+} // namespace
+
+void DrawBatcher::begin() {
+    for (size_t i = 0; i < used_; ++i) {
+        batches_[i].points.clear();
+        batches_[i].segments.clear();
+        batches_[i].rects.clear();
+    }
+    used_ = 0;
+}
+
+DrawBatcher::Batch& DrawBatcher::batch_for(BatchKind kind, unsigned long pixel, const Bounds& bounds) {
+    size_t scanned = 0;
+    for (size_t i = used_; i > 0 && scanned < LOOKBACK; --i, ++scanned) {
+        Batch& batch = batches_[i - 1];
+        if (batch.kind == kind && batch.pixel == pixel) {
+            batch.bounds.merge(bounds);
+            return batch;
+        }
+        if (batch.bounds.intersects(bounds)) {
+            break;
+        }
+    }
+    if (used_ == batches_.size()) {
+        batches_.emplace_back();
+    }
+    Batch& batch = batches_[used_++];
+    batch.kind = kind;
+    batch.pixel = pixel;
+    batch.bounds = bounds;
+    return batch;
+}
+
+void DrawBatcher::add_point(int x, int y, unsigned long pixel) {
+    Batch& batch = batch_for(BatchKind::POINTS, pixel, Bounds{x, y, x + 1, y + 1});
+    batch.points.push_back(XPoint{clamp_coord(x), clamp_coord(y)});
+}
+
+void DrawBatcher::add_line(int x1, int y1, int x2, int y2, unsigned long pixel) {
+    Bounds bounds{std::min(x1, x2), std::min(y1, y2), std::max(x1, x2) + 1, std::max(y1, y2) + 1};
+    Batch& batch = batch_for(BatchKind::SEGMENTS, pixel, bounds);
+    batch.segments.push_back(XSegment{clamp_coord(x1), clamp_coord(y1), clamp_coord(x2), clamp_coord(y2)});
+}
+
+void DrawBatcher::add_rect(int x, int y, int width, int height, bool filled, unsigned long pixel) {
+    if (width < 0 || height < 0 || (filled && (width == 0 || height == 0))) {
+        return;
+    }
+    // Outlines cover one extra pixel on the right and bottom edges
+    int extra = filled ? 0 : 1;
+    Bounds bounds{x, y, x + width + extra, y + height + extra};
+    Batch& batch = batch_for(filled ? BatchKind::FILL_RECTS : BatchKind::OUTLINE_RECTS, pixel, bounds);
+    batch.rects.push_back(XRectangle{clamp_coord(x), clamp_coord(y), clamp_extent(width), clamp_extent(height)});
+}
+
+size_t DrawBatcher::submit(Display* dpy, Drawable target, GC gc) {
+    size_t requests = 0;
+    size_t max_points = items_per_request(dpy, 1);
+    size_t max_pairs = items_per_request(dpy, 2);
+    bool have_pixel = false;
+    unsigned long current_pixel = 0;
+
+    for (size_t i = 0; i < used_; ++i) {
+        Batch& batch = batches_[i];
+        if (!have_pixel || batch.pixel != current_pixel) {
+            // Xlib defers GC changes to the next drawing request; flushing
+            // the GC here keeps the ChangeGC in this call site's count
+            ENGINE_X_CALL(dpy, "DrawBatcher::submit XSetForeground");
+            XSetForeground(dpy, gc, batch.pixel);
+            XFlushGC(dpy, gc);
+            current_pixel = batch.pixel;
+            have_pixel = true;
+            requests++;
+        }
+        switch (batch.kind) {
+        case BatchKind::POINTS: {
+            ENGINE_X_CALL(dpy, "DrawBatcher::submit XDrawPoints");
+            for (size_t off = 0; off < batch.points.size(); off += max_points) {
+                int n = static_cast<int>(std::min(max_points, batch.points.size() - off));
+                XDrawPoints(dpy, target, gc, batch.points.data() + off, n, CoordModeOrigin);
+                requests++;
+            }
+            break;
+        }
+        case BatchKind::SEGMENTS: {
+            ENGINE_X_CALL(dpy, "DrawBatcher::submit XDrawSegments");
+            for (size_t off = 0; off < batch.segments.size(); off += max_pairs) {
+                int n = static_cast<int>(std::min(max_pairs, batch.segments.size() - off));
+                XDrawSegments(dpy, target, gc, batch.segments.data() + off, n);
+                requests++;
+            }
+            break;
+        }
+        case BatchKind::FILL_RECTS: {
+            ENGINE_X_CALL(dpy, "DrawBatcher::submit XFillRectangles");
+            for (size_t off = 0; off < batch.rects.size(); off += max_pairs) {
+                int n = static_cast<int>(std::min(max_pairs, batch.rects.size() - off));
+                XFillRectangles(dpy, target, gc, batch.rects.data() + off, n);
+                requests++;
+            }
+            break;
+        }
+        case BatchKind::OUTLINE_RECTS: {
+            ENGINE_X_CALL(dpy, "DrawBatcher::submit XDrawRectangles");
+            for (size_t off = 0; off < batch.rects.size(); off += max_pairs) {
+                int n = static_cast<int>(std::min(max_pairs, batch.rects.size() - off));
+                XDrawRectangles(dpy, target, gc, batch.rects.data() + off, n);
+                requests++;
+            }
+            break;
+        }
+        }
+    }
+    return requests;
+}
+
+} // namespace platform
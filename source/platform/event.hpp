@@ -3,29 +3,56 @@
 
 #include "window.hpp"
 #include "renderer.hpp"
+#include "input.hpp"
+#include "spsc_queue.hpp"
+#include <atomic>
+#include <cstddef>
+#include <thread>
 
 namespace platform {
 
-    enum class EventKind {
-        EXIT,
-        NONE,
-        LEFT_CLICK,
-        RIGHT_CLICK,
-        MIDDLE_CLICK,
-        KEY_A,
-        KEY_ESC,
-        KEY_UP,
-        KEY_DOWN,
-        KEY_LEFT,
-        KEY_RIGHT,
-        KEY_SPACE,
-        EXPOSE
-    };
+    // Input pump. Each pump() drains every queued X event in one go into a
+    // fixed-capacity buffer, updating the key-state table and mouse state as
+    // it goes (consecutive pointer motion is merged into one event). Events
+    // are handed out once: either one at a time through poll(), or in the
+    // snapshot returned by capture(), which update code reads without
+    // touching Xlib. Nothing is allocated per event.
+    //
+    // With input_thread set (or ENGINE_INPUT_THREAD=1 in the environment) a
+    // dedicated thread owns a second X connection that receives all key,
+    // button, motion and focus events. It timestamps them as they come off
+    // the socket and hands them to the game thread through a lock-free
+    // queue, so a long update or present no longer leaves input sitting
+    // unread in the socket. The window's own connection keeps Expose,
+    // ClientMessage and SHM completion events. The XCB backend reads its
+    // connection directly and ignores input_thread.
+    namespace event_detail {
+        // Shared by the Xlib and XCB translations
+        Key key_from_keysym(uint32_t keysym);
+        EventKind key_kind(Key key);
+        EventKind click_kind(MouseButton button);
+    }
 
     class Event {
     public:
-        Event(const Window& window);
+        Event(const Window& window, bool input_thread = false);
+        ~Event();
+        Event(const Event&) = delete;
+        Event& operator=(const Event&) = delete;
+        // Returns the next buffered event, injected or from X (none when
+        // headless), pumping when the buffer is empty. Every event is
+        // returned; kind() is NONE for ones without a legacy kind.
         bool poll(Renderer& renderer);
+        // Drains all pending X events. Returns how many were buffered.
+        size_t pump(Renderer& renderer);
+        // Pumps, then publishes the input state and the events poll() has
+        // not returned as an immutable snapshot, and starts the next one.
+        const InputSnapshot& capture(Renderer& renderer);
+        // The last captured snapshot
+        const InputSnapshot& input() const { return published_; }
+        // Queues a synthetic event for the next poll(), e.g. scripted input
+        // for headless runs. Key kinds count as a tap: pressed and released.
+        void inject(EventKind kind, int x = 0, int y = 0);
         void draw() const;
         void wait() const;
         EventKind kind() const;
@@ -34,15 +61,46 @@ namespace platform {
         int x() const { return x_; }
         int y() const { return y_; }
         KeySym keysym() const { return keysym_; }
+        // Full details of the event last returned by poll()
+        const InputEvent& current() const { return current_; }
+
+        bool threaded() const { return input_thread_.joinable(); }
+        // Readable when the input thread has queued events, -1 when not
+        // threaded; hand it to FrameScheduler::watch() so input wakes the loop.
+        int wake_fd() const { return wake_fd_; }
+        // Events the input thread dropped because the queue was full
+        uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
 
     private:
+        static constexpr size_t QUEUE_CAPACITY = 1024;
+
+        void start_input_thread(const Window& window);
+        size_t pump_xcb(Renderer& renderer);
+        void input_loop();
+        size_t drain_queue(Renderer& renderer);
+        void apply(const InputEvent& event, Renderer& renderer);
+        void push(const InputEvent& event);
+        void key(Key key, bool down, bool repeat);
+        void button(MouseButton button, bool down);
+
         EventKind kind_;
+        const Window& window_;
         Display* dpy_;
         ::Window wd_;
-        XEvent event_;
         int x_;
         int y_;
         KeySym keysym_;
+        InputEvent current_;
+        InputSnapshot pending_;   // Being filled by pump()
+        InputSnapshot published_; // Returned by capture()
+
+        // Input thread
+        Display* input_dpy_;
+        int wake_fd_;
+        int stop_fd_;
+        std::atomic<uint64_t> dropped_;
+        SpscQueue<InputEvent, QUEUE_CAPACITY> queue_;
+        std::thread input_thread_;
     };
 
 } // namespace platform
@@ -1,50 +1,500 @@
 #include "event.hpp"
+#include "log.hpp"
+#include "profiler.hpp"
+#include "x_traffic.hpp"
+#include <cerrno>
+#include <cstdlib>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/eventfd.h>
+#include <unistd.h>
 #include <X11/keysym.h>
+#include <X11/XKBlib.h>
 #include <X11/Xutil.h>
-#include <iostream>
 
 namespace platform {
 
-    Event::Event(const Window& window)
+    namespace event_detail {
+
+        Key key_from_keysym(uint32_t keysym) {
+            if (keysym >= XK_a && keysym <= XK_z) {
+                return static_cast<Key>(static_cast<int>(Key::A) + static_cast<int>(keysym - XK_a));
+            }
+            if (keysym >= XK_0 && keysym <= XK_9) {
+                return static_cast<Key>(static_cast<int>(Key::NUM_0) + static_cast<int>(keysym - XK_0));
+            }
+            if (keysym >= XK_F1 && keysym <= XK_F12) {
+                return static_cast<Key>(static_cast<int>(Key::F1) + static_cast<int>(keysym - XK_F1));
+            }
+            switch (keysym) {
+                case XK_space: return Key::SPACE;
+                case XK_Escape: return Key::ESCAPE;
+                case XK_Return: return Key::ENTER;
+                case XK_Tab: return Key::TAB;
+                case XK_BackSpace: return Key::BACKSPACE;
+                case XK_Up: return Key::UP;
+                case XK_Down: return Key::DOWN;
+                case XK_Left: return Key::LEFT;
+                case XK_Right: return Key::RIGHT;
+                case XK_Shift_L: return Key::LEFT_SHIFT;
+                case XK_Shift_R: return Key::RIGHT_SHIFT;
+                case XK_Control_L: return Key::LEFT_CTRL;
+                case XK_Control_R: return Key::RIGHT_CTRL;
+                case XK_Alt_L: return Key::LEFT_ALT;
+                case XK_Alt_R: return Key::RIGHT_ALT;
+                default: return Key::UNKNOWN;
+            }
+        }
+
+        EventKind key_kind(Key key) {
+            switch (key) {
+                case Key::SPACE: return EventKind::KEY_SPACE;
+                case Key::ESCAPE: return EventKind::KEY_ESC;
+                case Key::A: return EventKind::KEY_A;
+                case Key::UP: return EventKind::KEY_UP;
+                case Key::DOWN: return EventKind::KEY_DOWN;
+                case Key::LEFT: return EventKind::KEY_LEFT;
+                case Key::RIGHT: return EventKind::KEY_RIGHT;
+                default: return EventKind::NONE;
+            }
+        }
+
+        EventKind click_kind(MouseButton button) {
+            switch (button) {
+                case MouseButton::LEFT: return EventKind::LEFT_CLICK;
+                case MouseButton::MIDDLE: return EventKind::MIDDLE_CLICK;
+                default: return EventKind::RIGHT_CLICK;
+            }
+        }
+
+    } // namespace event_detail
+
+    namespace {
+
+        using namespace event_detail;
+
+        // Inverse of the legacy mapping, for inject()
+        InputEvent from_legacy(EventKind kind, int x, int y) {
+            InputEvent event;
+            event.kind = kind;
+            event.x = x;
+            event.y = y;
+            switch (kind) {
+                case EventKind::EXIT: event.type = InputType::CLOSE; break;
+                case EventKind::EXPOSE: event.type = InputType::EXPOSE; break;
+                case EventKind::LEFT_CLICK: event.type = InputType::BUTTON_PRESS; event.button = MouseButton::LEFT; break;
+                case EventKind::MIDDLE_CLICK: event.type = InputType::BUTTON_PRESS; event.button = MouseButton::MIDDLE; break;
+                case EventKind::RIGHT_CLICK: event.type = InputType::BUTTON_PRESS; event.button = MouseButton::RIGHT; break;
+                case EventKind::KEY_A: event.type = InputType::KEY_PRESS; event.key = Key::A; break;
+                case EventKind::KEY_ESC: event.type = InputType::KEY_PRESS; event.key = Key::ESCAPE; break;
+                case EventKind::KEY_UP: event.type = InputType::KEY_PRESS; event.key = Key::UP; break;
+                case EventKind::KEY_DOWN: event.type = InputType::KEY_PRESS; event.key = Key::DOWN; break;
+                case EventKind::KEY_LEFT: event.type = InputType::KEY_PRESS; event.key = Key::LEFT; break;
+                case EventKind::KEY_RIGHT: event.type = InputType::KEY_PRESS; event.key = Key::RIGHT; break;
+                case EventKind::KEY_SPACE: event.type = InputType::KEY_PRESS; event.key = Key::SPACE; break;
+                case EventKind::NONE: event.type = InputType::MOTION; break; // Pointer to (x, y)
+            }
+            return event;
+        }
+
+        // Xlib-free copy of an X input event. Returns false for events that
+        // carry no input. Safe to call on the input thread: the keysym lookup
+        // goes through the event's own connection.
+        bool translate(const XEvent& xevent, InputEvent& event) {
+            switch (xevent.type) {
+                case Expose:
+                    event.type = InputType::EXPOSE;
+                    event.kind = EventKind::EXPOSE;
+                    event.x = xevent.xexpose.x;
+                    event.y = xevent.xexpose.y;
+                    event.width = xevent.xexpose.width;
+                    event.height = xevent.xexpose.height;
+                    return true;
+                case ConfigureNotify:
+                    event.type = InputType::RESIZE;
+                    event.width = xevent.xconfigure.width;
+                    event.height = xevent.xconfigure.height;
+                    return true;
+                case KeyPress:
+                case KeyRelease: {
+                    bool down = xevent.type == KeyPress;
+                    // Level 0 so Shift does not turn 'a' into 'A'
+                    KeySym keysym = XLookupKeysym(const_cast<XKeyEvent*>(&xevent.xkey), 0);
+                    event.type = down ? InputType::KEY_PRESS : InputType::KEY_RELEASE;
+                    event.key = key_from_keysym(keysym);
+                    event.keysym = static_cast<uint32_t>(keysym);
+                    event.kind = down ? key_kind(event.key) : EventKind::NONE;
+                    event.x = xevent.xkey.x;
+                    event.y = xevent.xkey.y;
+                    event.time = static_cast<uint32_t>(xevent.xkey.time);
+                    return true;
+                }
+                case ButtonPress:
+                case ButtonRelease: {
+                    bool down = xevent.type == ButtonPress;
+                    unsigned int x_button = xevent.xbutton.button;
+                    event.x = xevent.xbutton.x;
+                    event.y = xevent.xbutton.y;
+                    event.time = static_cast<uint32_t>(xevent.xbutton.time);
+                    if (x_button == Button4 || x_button == Button5) {
+                        // Each wheel notch is a press/release pair; count presses
+                        event.type = InputType::SCROLL;
+                        event.height = x_button == Button4 ? 1 : -1;
+                        return down;
+                    }
+                    if (x_button != Button1 && x_button != Button2 && x_button != Button3) {
+                        return false;
+                    }
+                    event.type = down ? InputType::BUTTON_PRESS : InputType::BUTTON_RELEASE;
+                    event.button = x_button == Button1 ? MouseButton::LEFT
+                                 : x_button == Button2 ? MouseButton::MIDDLE : MouseButton::RIGHT;
+                    event.kind = down ? click_kind(event.button) : EventKind::NONE;
+                    return true;
+                }
+                case MotionNotify:
+                    event.type = InputType::MOTION;
+                    event.x = xevent.xmotion.x;
+                    event.y = xevent.xmotion.y;
+                    event.time = static_cast<uint32_t>(xevent.xmotion.time);
+                    return true;
+                case FocusIn:
+                case FocusOut:
+                    event.type = xevent.type == FocusIn ? InputType::FOCUS_IN : InputType::FOCUS_OUT;
+                    return true;
+                case ClientMessage:
+                    event.type = InputType::CLOSE;
+                    event.kind = EventKind::EXIT;
+                    return true;
+                default:
+                    return false;
+            }
+        }
+
+        // Discrete input a player waits to see answered; motion and expose
+        // are left out
+        bool measures_latency(const InputEvent& event) {
+            switch (event.type) {
+                case InputType::KEY_PRESS:
+                case InputType::KEY_RELEASE:
+                case InputType::BUTTON_PRESS:
+                case InputType::BUTTON_RELEASE:
+                case InputType::SCROLL:
+                    return event.arrival_ns != 0 && !event.repeat;
+                default:
+                    return false;
+            }
+        }
+
+        bool input_thread_requested(bool input_thread) {
+            const char* env = std::getenv("ENGINE_INPUT_THREAD");
+            if (env) {
+                return std::atoi(env) != 0;
+            }
+            return input_thread;
+        }
+
+    } // namespace
+
+    Event::Event(const Window& window, bool input_thread)
         : kind_(EventKind::NONE),
+          window_(window),
           dpy_(window.get_display()),
           wd_(window.get_window()),
           x_(0),
           y_(0),
-          keysym_(0) {
-        std::cout << "Initialized event handler" << std::endl;
+          keysym_(0),
+          input_dpy_(nullptr),
+          wake_fd_(-1),
+          stop_fd_(-1),
+          dropped_(0) {
+        if (!dpy_) {
+            ENGINE_LOG_INFO("Initialized event handler");
+            return;
+        }
+        if (input_thread_requested(input_thread)) {
+            start_input_thread(window);
+            ENGINE_LOG_INFO("Initialized event handler with an input thread");
+        } else {
+            // Held keys then repeat as KeyPress only, instead of a synthetic
+            // KeyRelease/KeyPress pair that would flicker the key state
+            XkbSetDetectableAutoRepeat(dpy_, True, nullptr);
+            ENGINE_LOG_INFO("Initialized event handler");
+        }
     }
 
-    bool Event::poll(Renderer& renderer) {
-        if (!XPending(dpy_)) {
-            return false;
+    Event::~Event() {
+        if (input_thread_.joinable()) {
+            uint64_t one = 1;
+            if (write(stop_fd_, &one, sizeof(one)) == sizeof(one)) {
+                input_thread_.join();
+            } else {
+                input_thread_.detach();
+            }
+        }
+        if (input_dpy_) {
+            XCloseDisplay(input_dpy_);
+        }
+        for (int fd : {wake_fd_, stop_fd_}) {
+            if (fd >= 0) {
+                close(fd);
+            }
+        }
+    }
+
+    void Event::start_input_thread(const Window& window) {
+        input_dpy_ = XOpenDisplay(DisplayString(dpy_));
+        wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        stop_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (!input_dpy_ || wake_fd_ < 0 || stop_fd_ < 0) {
+            throw std::runtime_error("ERROR: Failed to set up the input thread");
+        }
+        // Only one client may select button presses, so the window's
+        // connection gives them up first; the XSync makes sure the server has
+        // seen that before the input connection asks for them.
+        {
+            ENGINE_X_CALL(dpy_, "Event::start_input_thread XSync");
+            XSelectInput(dpy_, wd_, WINDOW_EVENT_MASK);
+            XSync(dpy_, False);
+        }
+        XSelectInput(input_dpy_, window.get_window(), INPUT_EVENT_MASK);
+        XkbSetDetectableAutoRepeat(input_dpy_, True, nullptr);
+        XFlush(input_dpy_);
+        input_thread_ = std::thread(&Event::input_loop, this);
+    }
+
+    void Event::input_loop() {
+        if (ENGINE_PROFILE) {
+            profiler_set_thread_name("input");
+        }
+        pollfd fds[2] = {
+            {ConnectionNumber(input_dpy_), POLLIN, 0},
+            {stop_fd_, POLLIN, 0},
+        };
+        uint64_t one = 1;
+        while (true) {
+            bool queued = false;
+            while (XPending(input_dpy_)) {
+                XEvent xevent;
+                XNextEvent(input_dpy_, &xevent);
+                InputEvent event;
+                if (!translate(xevent, event)) {
+                    continue;
+                }
+                event.arrival_ns = monotonic_ns();
+                if (queue_.push(event)) {
+                    queued = true;
+                } else {
+                    dropped_.fetch_add(1, std::memory_order_relaxed);
+                }
+            }
+            if (queued && write(wake_fd_, &one, sizeof(one)) < 0 && errno != EAGAIN) {
+                ENGINE_LOG_WARN("Failed to signal queued input");
+            }
+            if (::poll(fds, 2, -1) < 0 && errno != EINTR) {
+                ENGINE_LOG_ERROR("Input thread stopped: poll failed");
+                return;
+            }
+            if (fds[1].revents & POLLIN) {
+                return;
+            }
+        }
+    }
+
+    void Event::inject(EventKind kind, int x, int y) {
+        InputEvent event = from_legacy(kind, x, y);
+        event.arrival_ns = monotonic_ns();
+        if (event.type == InputType::KEY_PRESS) {
+            pending_.pressed_keys.set(event.key);
+            pending_.released_keys.set(event.key);
+        } else if (event.type == InputType::BUTTON_PRESS) {
+            pending_.mouse.pressed |= MouseState::bit(event.button);
+            pending_.mouse.released |= MouseState::bit(event.button);
+        } else if (event.type == InputType::MOTION) {
+            pending_.mouse.x = x;
+            pending_.mouse.y = y;
+        } else if (event.type == InputType::CLOSE) {
+            pending_.close_requested = true;
+        }
+        push(event);
+    }
+
+    void Event::push(const InputEvent& event) {
+        if ((event.type == InputType::MOTION || event.type == InputType::RESIZE) && !pending_.events.empty() &&
+            pending_.events.back().type == event.type) {
+            pending_.events.back() = event;
+            if (event.type == InputType::MOTION) {
+                pending_.coalesced_motion++;
+            }
+            return;
+        }
+        // When full the event is dropped and counted; state is already updated
+        pending_.events.push(event);
+    }
+
+    void Event::key(Key key, bool down, bool repeat) {
+        if (key == Key::UNKNOWN || repeat) {
+            return;
+        }
+        pending_.keys.set(key, down);
+        (down ? pending_.pressed_keys : pending_.released_keys).set(key);
+    }
+
+    void Event::button(MouseButton button, bool down) {
+        uint8_t bit = MouseState::bit(button);
+        MouseState& mouse = pending_.mouse;
+        mouse.buttons = down ? (mouse.buttons | bit) : (mouse.buttons & ~bit);
+        (down ? mouse.pressed : mouse.released) |= bit;
+    }
+
+    // Folds one translated event into the key/mouse state and the buffer
+    void Event::apply(const InputEvent& input, Renderer& renderer) {
+        InputEvent event = input;
+        MouseState& mouse = pending_.mouse;
+        switch (event.type) {
+            case InputType::EXPOSE:
+                renderer.invalidate(event.x, event.y, event.width, event.height);
+                break;
+            case InputType::RESIZE:
+                // ConfigureNotify also reports moves and restacking
+                if (event.width == renderer.width() && event.height == renderer.height()) {
+                    return;
+                }
+                renderer.resize(event.width, event.height);
+                break;
+            case InputType::KEY_PRESS:
+            case InputType::KEY_RELEASE: {
+                bool down = event.type == InputType::KEY_PRESS;
+                event.repeat = down && event.key != Key::UNKNOWN && pending_.keys.test(event.key);
+                key(event.key, down, event.repeat);
+                break;
+            }
+            case InputType::BUTTON_PRESS:
+            case InputType::BUTTON_RELEASE:
+                mouse.x = event.x;
+                mouse.y = event.y;
+                button(event.button, event.type == InputType::BUTTON_PRESS);
+                break;
+            case InputType::SCROLL:
+                mouse.x = event.x;
+                mouse.y = event.y;
+                mouse.wheel += event.height;
+                break;
+            case InputType::MOTION:
+                mouse.x = event.x;
+                mouse.y = event.y;
+                break;
+            case InputType::FOCUS_IN:
+                pending_.focused = true;
+                break;
+            case InputType::FOCUS_OUT:
+                // Releases will go to another window; let go of everything
+                pending_.focused = false;
+                for (size_t i = 1; i < static_cast<size_t>(Key::COUNT); ++i) {
+                    if (pending_.keys.test(static_cast<Key>(i))) {
+                        key(static_cast<Key>(i), false, false);
+                    }
+                }
+                mouse.released |= mouse.buttons;
+                mouse.buttons = 0;
+                break;
+            case InputType::CLOSE:
+                pending_.close_requested = true;
+                break;
         }
+        push(event);
+    }
 
-        XNextEvent(dpy_, &event_);
-        kind_ = EventKind::NONE;
+    size_t Event::drain_queue(Renderer& renderer) {
+        // Clear the wake-up before draining, so a push racing with the drain
+        // signals again instead of being left behind
+        uint64_t signals = 0;
+        if (read(wake_fd_, &signals, sizeof(signals)) < 0 && errno != EAGAIN) {
+            ENGINE_LOG_WARN("Failed to clear the input wake-up");
+        }
+        size_t count = 0;
+        InputEvent event;
+        while (queue_.pop(event)) {
+            apply(event, renderer);
+            count++;
+        }
+        return count;
+    }
 
-        if (event_.type == Expose) {
-            kind_ = EventKind::EXPOSE;
-            std::cout << "Event: EXPOSE" << std::endl;
-            return true;
-        } else if (event_.type == KeyPress) {
-            keysym_ = XLookupKeysym(&event_.xkey, 0);
-            if (keysym_ == XK_space) {
-                kind_ = EventKind::KEY_SPACE;
-                std::cout << "Event: KEY_SPACE" << std::endl;
-                return true;
-            } else if (keysym_ == XK_Escape) {
-                kind_ = EventKind::KEY_ESC;
-                std::cout << "Event: KEY_ESC" << std::endl;
-                return true;
+    size_t Event::pump(Renderer& renderer) {
+        ENGINE_PROFILE_ZONE("Event::pump");
+        if (window_.is_xcb()) {
+            ScopeTimer timer(renderer.frame_stats(), FramePhase::POLL);
+            return pump_xcb(renderer);
+        }
+        if (!dpy_) {
+            return 0;
+        }
+        ScopeTimer timer(renderer.frame_stats(), FramePhase::POLL);
+        size_t count = 0;
+        // One flush and socket read, then everything Xlib already holds
+        int queued;
+        {
+            ENGINE_X_CALL(dpy_, "Event::pump XPending");
+            queued = XPending(dpy_);
+        }
+        while (queued > 0) {
+            uint64_t arrival = monotonic_ns();
+            for (; queued > 0; --queued, ++count) {
+                XEvent xevent;
+                XNextEvent(dpy_, &xevent);
+                InputEvent event;
+                if (!renderer.handle_event(xevent) && translate(xevent, event)) {
+                    event.arrival_ns = arrival;
+                    apply(event, renderer);
+                }
             }
-        } else if (event_.type == ClientMessage) {
-            kind_ = EventKind::EXIT;
-            std::cout << "Event: EXIT" << std::endl;
-            return true;
+            queued = XEventsQueued(dpy_, QueuedAfterReading);
+        }
+        if (threaded()) {
+            count += drain_queue(renderer);
+        }
+        if (count > 0) {
+            ENGINE_LOG_DEBUG("Pumped {} X events", count);
         }
+        return count;
+    }
+
+    bool Event::poll(Renderer& renderer) {
+        if (pending_.events.empty()) {
+            pump(renderer);
+        }
+        if (!pending_.events.pop(current_)) {
+            return false;
+        }
+        if (measures_latency(current_)) {
+            renderer.frame_stats().add_input(current_.arrival_ns);
+        }
+        kind_ = current_.kind;
+        x_ = current_.x;
+        y_ = current_.y;
+        keysym_ = current_.keysym;
+        return true;
+    }
 
-        return false;
+    const InputSnapshot& Event::capture(Renderer& renderer) {
+        pump(renderer);
+        pending_.frame++;
+        for (size_t i = 0; i < pending_.events.size(); ++i) {
+            if (measures_latency(pending_.events[i])) {
+                renderer.frame_stats().add_input(pending_.events[i].arrival_ns);
+            }
+        }
+        published_ = pending_;
+        // Held state carries over; edges and events start afresh
+        pending_.pressed_keys.clear();
+        pending_.released_keys.clear();
+        pending_.mouse.pressed = 0;
+        pending_.mouse.released = 0;
+        pending_.mouse.wheel = 0;
+        pending_.close_requested = false;
+        pending_.coalesced_motion = 0;
+        pending_.events.clear();
+        return published_;
     }
 
     EventKind Event::kind() const {
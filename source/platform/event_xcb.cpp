@@ -0,0 +1,136 @@
+#include "event.hpp"
+#include "log.hpp"
+#include <cstdlib>
+
+namespace platform {
+
+    namespace {
+
+        using namespace event_detail;
+
+        // Xlib-free copy of an XCB input event, as translate() does for
+        // Xlib. Returns false for events that carry no input.
+        bool translate_xcb(const Window& window, const xcb_generic_event_t* generic, InputEvent& event) {
+            switch (generic->response_type & ~0x80) {
+                case XCB_EXPOSE: {
+                    auto expose = reinterpret_cast<const xcb_expose_event_t*>(generic);
+                    event.type = InputType::EXPOSE;
+                    event.kind = EventKind::EXPOSE;
+                    event.x = expose->x;
+                    event.y = expose->y;
+                    event.width = expose->width;
+                    event.height = expose->height;
+                    return true;
+                }
+                case XCB_CONFIGURE_NOTIFY: {
+                    auto configure = reinterpret_cast<const xcb_configure_notify_event_t*>(generic);
+                    event.type = InputType::RESIZE;
+                    event.width = configure->width;
+                    event.height = configure->height;
+                    return true;
+                }
+                case XCB_KEY_PRESS:
+                case XCB_KEY_RELEASE: {
+                    auto key = reinterpret_cast<const xcb_key_press_event_t*>(generic);
+                    bool down = (generic->response_type & ~0x80) == XCB_KEY_PRESS;
+                    event.type = down ? InputType::KEY_PRESS : InputType::KEY_RELEASE;
+                    event.keysym = window.xcb_keysym(key->detail);
+                    event.key = key_from_keysym(event.keysym);
+                    event.kind = down ? key_kind(event.key) : EventKind::NONE;
+                    event.x = key->event_x;
+                    event.y = key->event_y;
+                    event.time = key->time;
+                    return true;
+                }
+                case XCB_BUTTON_PRESS:
+                case XCB_BUTTON_RELEASE: {
+                    auto button = reinterpret_cast<const xcb_button_press_event_t*>(generic);
+                    bool down = (generic->response_type & ~0x80) == XCB_BUTTON_PRESS;
+                    event.x = button->event_x;
+                    event.y = button->event_y;
+                    event.time = button->time;
+                    if (button->detail == 4 || button->detail == 5) {
+                        // Each wheel notch is a press/release pair; count presses
+                        event.type = InputType::SCROLL;
+                        event.height = button->detail == 4 ? 1 : -1;
+                        return down;
+                    }
+                    if (button->detail < 1 || button->detail > 3) {
+                        return false;
+                    }
+                    event.type = down ? InputType::BUTTON_PRESS : InputType::BUTTON_RELEASE;
+                    event.button = button->detail == 1 ? MouseButton::LEFT
+                                 : button->detail == 2 ? MouseButton::MIDDLE : MouseButton::RIGHT;
+                    event.kind = down ? click_kind(event.button) : EventKind::NONE;
+                    return true;
+                }
+                case XCB_MOTION_NOTIFY: {
+                    auto motion = reinterpret_cast<const xcb_motion_notify_event_t*>(generic);
+                    event.type = InputType::MOTION;
+                    event.x = motion->event_x;
+                    event.y = motion->event_y;
+                    event.time = motion->time;
+                    return true;
+                }
+                case XCB_FOCUS_IN:
+                case XCB_FOCUS_OUT:
+                    event.type = (generic->response_type & ~0x80) == XCB_FOCUS_IN ? InputType::FOCUS_IN
+                                                                                   : InputType::FOCUS_OUT;
+                    return true;
+                case XCB_CLIENT_MESSAGE: {
+                    auto message = reinterpret_cast<const xcb_client_message_event_t*>(generic);
+                    if (message->data.data32[0] != window.wm_delete_window()) {
+                        return false;
+                    }
+                    event.type = InputType::CLOSE;
+                    event.kind = EventKind::EXIT;
+                    return true;
+                }
+                case 0: {
+                    auto error = reinterpret_cast<const xcb_generic_error_t*>(generic);
+                    ENGINE_LOG_ERROR("X11 Error: code {} on request {}.{}", error->error_code, error->major_code,
+                                     error->minor_code);
+                    return false;
+                }
+                default:
+                    return false;
+            }
+        }
+
+        // Without XKB's detectable auto-repeat, a held key arrives as
+        // release/press pairs sharing a timestamp
+        bool is_repeat_release(const xcb_generic_event_t* release, const xcb_generic_event_t* next) {
+            if (!next || (next->response_type & ~0x80) != XCB_KEY_PRESS) {
+                return false;
+            }
+            auto up = reinterpret_cast<const xcb_key_release_event_t*>(release);
+            auto down = reinterpret_cast<const xcb_key_press_event_t*>(next);
+            return up->detail == down->detail && up->time == down->time;
+        }
+
+    } // namespace
+
+    // One socket read, then whatever xcb already holds; nothing here waits
+    // for a reply
+    size_t Event::pump_xcb(Renderer& renderer) {
+        size_t count = 0;
+        bool read_socket = true;
+        while (xcb_generic_event_t* generic = window_.next_xcb_event(read_socket)) {
+            read_socket = false;
+            count++;
+            InputEvent event;
+            bool release = (generic->response_type & ~0x80) == XCB_KEY_RELEASE;
+            if (!(release && is_repeat_release(generic, window_.peek_xcb_event())) &&
+                translate_xcb(window_, generic, event)) {
+                event.arrival_ns = monotonic_ns();
+                apply(event, renderer);
+            }
+            std::free(generic);
+        }
+        if (count > 0) {
+            ENGINE_LOG_DEBUG("Pumped {} XCB events", count);
+        }
+        return count;
+    }
+
+} // namespace platform
\ No newline at end of file
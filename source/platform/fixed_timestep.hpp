@@ -0,0 +1,65 @@
+#ifndef PLATFORM_FIXED_TIMESTEP_HPP
+#define PLATFORM_FIXED_TIMESTEP_HPP
+
+#include <algorithm>
+#include <cstdint>
+
+namespace platform {
+
+    // Fixed-step simulation clock. Real frame time goes into an accumulator
+    // that is spent in whole steps, so simulation runs at the same rate
+    // whatever the present rate. At most max_steps are run per frame; time
+    // beyond that is dropped rather than caught up later, so one slow frame
+    // cannot snowball into ever longer frames. alpha() is how far the
+    // leftover time reaches into the next step, for drawing objects between
+    // their previous and current state.
+    class FixedTimestep {
+    public:
+        explicit FixedTimestep(double rate_hz = 120.0, int max_steps = 8) {
+            set_rate(rate_hz);
+            set_max_steps(max_steps);
+        }
+
+        void set_rate(double rate_hz) { step_ = 1.0 / std::max(rate_hz, 1.0); }
+        double rate() const { return 1.0 / step_; }
+        // Seconds per step
+        double step() const { return step_; }
+
+        void set_max_steps(int max_steps) { max_steps_ = std::max(max_steps, 1); }
+        int max_steps() const { return max_steps_; }
+
+        // Adds elapsed real time and returns how many steps to simulate now.
+        int advance(double elapsed_s) {
+            accumulator_ += std::max(elapsed_s, 0.0);
+            int steps = static_cast<int>(accumulator_ / step_);
+            if (steps > max_steps_) {
+                dropped_ += static_cast<uint64_t>(steps - max_steps_);
+                steps = max_steps_;
+                accumulator_ = 0.0;
+            } else {
+                accumulator_ -= steps * step_;
+            }
+            return steps;
+        }
+
+        // In [0, 1): blend factor between the previous and current state.
+        double alpha() const { return std::min(accumulator_ / step_, 1.0); }
+        // Steps skipped because a frame needed more than max_steps.
+        uint64_t dropped_steps() const { return dropped_; }
+        void reset() { accumulator_ = 0.0; }
+
+    private:
+        double step_ = 1.0 / 120.0;
+        int max_steps_ = 8;
+        double accumulator_ = 0.0;
+        uint64_t dropped_ = 0;
+    };
+
+    // Linear blend for interpolated drawing
+    inline float lerp(float previous, float current, double alpha) {
+        return static_cast<float>(previous + (current - previous) * alpha);
+    }
+
+} // namespace platform
+
+#endif // PLATFORM_FIXED_TIMESTEP_HPP
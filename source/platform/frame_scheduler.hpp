@@ -0,0 +1,55 @@
+#ifndef PLATFORM_FRAME_SCHEDULER_HPP
+#define PLATFORM_FRAME_SCHEDULER_HPP
+
+#include "window.hpp"
+#include <cstdint>
+
+namespace platform {
+
+    enum class WakeReason {
+        FRAME, // The next frame deadline has passed
+        INPUT  // The X connection has events to read
+    };
+
+    // Blocks the main loop until the next frame deadline (a periodic
+    // timerfd on CLOCK_MONOTONIC) or until input arrives on the X connection,
+    // instead of sleeping and polling. Deadlines sit on a fixed grid, so a
+    // late frame does not shift the ones after it.
+    class FrameScheduler {
+    public:
+        explicit FrameScheduler(const Window& window, double rate_hz = 60.0);
+        ~FrameScheduler();
+        FrameScheduler(const FrameScheduler&) = delete;
+        FrameScheduler& operator=(const FrameScheduler&) = delete;
+
+        // Frames per second; 0 runs unpaced, wait() then returns FRAME at once.
+        void set_rate(double rate_hz);
+        double rate() const { return rate_hz_; }
+        // Also wake with INPUT when fd turns readable, e.g. Event::wake_fd()
+        // of an input thread; -1 stops watching.
+        void watch(int fd) { watch_fd_ = fd; }
+
+        // With idle set (the renderer had nothing to present), frame
+        // deadlines are ignored and the call blocks until input arrives; a
+        // static scene then costs no wake-ups at all. Without a display
+        // there is no input to wait for and idle is ignored.
+        WakeReason wait(bool idle = false);
+        // Deadlines that passed unserved before the last FRAME wake-up.
+        uint64_t missed() const { return missed_; }
+
+    private:
+        WakeReason wait_for_input();
+        bool events_queued() const;
+
+        const Window& window_;
+        Display* dpy_;
+        int connection_fd_; // -1 when headless
+        int timer_fd_;
+        int watch_fd_;
+        double rate_hz_;
+        uint64_t missed_;
+    };
+
+} // namespace platform
+
+#endif // PLATFORM_FRAME_SCHEDULER_HPP
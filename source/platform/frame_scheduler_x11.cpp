@@ -0,0 +1,112 @@
+#include "frame_scheduler.hpp"
+#include "profiler.hpp"
+#include "x_traffic.hpp"
+#include <cerrno>
+#include <poll.h>
+#include <stdexcept>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+namespace platform {
+
+FrameScheduler::FrameScheduler(const Window& window, double rate_hz)
+    : window_(window),
+      dpy_(window.get_display()),
+      connection_fd_(window.connection_fd()),
+      timer_fd_(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC)),
+      watch_fd_(-1),
+      rate_hz_(0),
+      missed_(0) {
+    if (timer_fd_ < 0) {
+        throw std::runtime_error("ERROR: Failed to create frame timer");
+    }
+    set_rate(rate_hz);
+}
+
+FrameScheduler::~FrameScheduler() {
+    close(timer_fd_);
+}
+
+void FrameScheduler::set_rate(double rate_hz) {
+    rate_hz_ = rate_hz > 0 ? rate_hz : 0;
+    itimerspec spec{};
+    if (rate_hz_ > 0) {
+        long long period = static_cast<long long>(1e9 / rate_hz_);
+        spec.it_interval.tv_sec = static_cast<time_t>(period / 1000000000);
+        spec.it_interval.tv_nsec = static_cast<long>(period % 1000000000);
+        spec.it_value = spec.it_interval;
+    }
+    // A zero it_value disarms the timer
+    if (timerfd_settime(timer_fd_, 0, &spec, nullptr) < 0) {
+        throw std::runtime_error("ERROR: Failed to arm frame timer");
+    }
+}
+
+WakeReason FrameScheduler::wait(bool idle) {
+    if (idle && (connection_fd_ >= 0 || watch_fd_ >= 0)) {
+        return wait_for_input();
+    }
+    if (rate_hz_ <= 0) {
+        missed_ = 0;
+        return WakeReason::FRAME;
+    }
+    if (events_queued()) {
+        return WakeReason::INPUT;
+    }
+
+    ENGINE_PROFILE_ZONE("FrameScheduler::wait");
+    pollfd fds[3] = {
+        {timer_fd_, POLLIN, 0},
+        {connection_fd_, POLLIN, 0}, // Negative fds are ignored
+        {watch_fd_, POLLIN, 0},
+    };
+    while (::poll(fds, 3, -1) < 0) {
+        if (errno != EINTR) {
+            throw std::runtime_error("ERROR: Waiting for the next frame failed");
+        }
+    }
+    if (fds[0].revents & POLLIN) {
+        uint64_t expirations = 0;
+        if (read(timer_fd_, &expirations, sizeof(expirations)) == sizeof(expirations) && expirations > 0) {
+            missed_ = expirations - 1;
+            return WakeReason::FRAME;
+        }
+    }
+    return WakeReason::INPUT;
+}
+
+// Events already read off the socket will not show up on the fd
+bool FrameScheduler::events_queued() const {
+    if (window_.is_xcb()) {
+        return window_.peek_xcb_event() != nullptr;
+    }
+    if (!dpy_) {
+        return false;
+    }
+    ENGINE_X_CALL(dpy_, "FrameScheduler::events_queued XPending");
+    return XPending(dpy_) > 0;
+}
+
+WakeReason FrameScheduler::wait_for_input() {
+    if (!events_queued()) {
+        ENGINE_PROFILE_ZONE("FrameScheduler::idle");
+        pollfd fds[2] = {
+            {connection_fd_, POLLIN, 0},
+            {watch_fd_, POLLIN, 0},
+        };
+        while (::poll(fds, 2, -1) < 0) {
+            if (errno != EINTR) {
+                throw std::runtime_error("ERROR: Waiting for input failed");
+            }
+        }
+    }
+    // Deadlines that passed while idle were not missed, just not needed
+    uint64_t expirations = 0;
+    if (read(timer_fd_, &expirations, sizeof(expirations)) < 0 && errno != EAGAIN) {
+        throw std::runtime_error("ERROR: Failed to reset frame timer");
+    }
+    missed_ = 0;
+    return WakeReason::INPUT;
+}
+
+} // namespace platform
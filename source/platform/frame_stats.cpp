@@ -0,0 +1,252 @@
+#include "frame_stats.hpp"
+#include "input.hpp"
+#include "log.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+
+namespace platform {
+
+const char* frame_phase_name(FramePhase phase) {
+    switch (phase) {
+    case FramePhase::POLL: return "poll";
+    case FramePhase::UPDATE: return "update";
+    case FramePhase::BUILD: return "build";
+    case FramePhase::SUBMIT: return "submit";
+    case FramePhase::FLUSH: return "flush";
+    case FramePhase::FRAME: return "frame";
+    case FramePhase::COUNT: break;
+    }
+    return "?";
+}
+
+size_t LatencyHistogram::bucket_of(uint64_t us) {
+    if (us < LINEAR) {
+        return static_cast<size_t>(us);
+    }
+    int msb = 63 - __builtin_clzll(us); // >= 5
+    int shift = msb - 4;
+    size_t bucket = LINEAR + static_cast<size_t>(msb - 5) * SUB + static_cast<size_t>((us >> shift) - SUB);
+    return std::min(bucket, BUCKETS - 1);
+}
+
+uint64_t LatencyHistogram::bucket_mid_ns(size_t bucket) {
+    if (bucket < LINEAR) {
+        return bucket * 1000 + 500;
+    }
+    size_t band = (bucket - LINEAR) / SUB;
+    size_t sub = (bucket - LINEAR) % SUB;
+    int shift = static_cast<int>(band) + 1;
+    uint64_t low = static_cast<uint64_t>(SUB + sub) << shift;
+    return (low * 1000) + (uint64_t(1000) << shift) / 2;
+}
+
+void LatencyHistogram::record(uint64_t ns) {
+    buckets_[bucket_of(ns / 1000)]++;
+    count_++;
+    sum_ns_ += ns;
+    max_ns_ = std::max(max_ns_, ns);
+}
+
+void LatencyHistogram::clear() {
+    buckets_.fill(0);
+    count_ = 0;
+    sum_ns_ = 0;
+    max_ns_ = 0;
+}
+
+uint64_t LatencyHistogram::percentile_ns(double p) const {
+    if (count_ == 0) {
+        return 0;
+    }
+    uint64_t target = static_cast<uint64_t>(std::ceil(p / 100.0 * count_));
+    target = std::max<uint64_t>(target, 1);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < BUCKETS; ++i) {
+        seen += buckets_[i];
+        if (seen >= target) {
+            return std::min(bucket_mid_ns(i), max_ns_);
+        }
+    }
+    return max_ns_;
+}
+
+FrameStats::FrameStats()
+    : budget_ns_(16666667),
+      has_last_frame_(false),
+      dump_interval_(std::chrono::seconds(5)) {
+    clear(total_);
+    clear(interval_);
+}
+
+void FrameStats::end_frame(Clock::time_point now) {
+    if (input_count_ > 0) {
+        uint64_t shown = monotonic_ns();
+        for (size_t i = 0; i < input_count_; ++i) {
+            uint64_t latency = shown > inputs_[i] ? shown - inputs_[i] : 0;
+            total_.input_latency.record(latency);
+            interval_.input_latency.record(latency);
+        }
+        input_count_ = 0;
+    }
+    if (has_last_frame_) {
+        pending_[static_cast<size_t>(FramePhase::FRAME)] =
+            static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_frame_).count());
+        // Refreshes skipped beyond the one the frame was due for, rounded
+        // to the nearest refresh: an interval jittering around one budget
+        // drops nothing, one of 2.5 budgets hides two refreshes
+        uint64_t frame_ns = pending_[static_cast<size_t>(FramePhase::FRAME)];
+        uint64_t budget_ns = std::max<uint64_t>(budget_ns_, 1);
+        uint64_t missed = frame_ns > budget_ns * 3 / 2 ? (frame_ns + budget_ns / 2) / budget_ns - 1 : 0;
+        for (Window* window : {&total_, &interval_}) {
+            for (size_t i = 0; i < pending_.size(); ++i) {
+                window->phases[i].record(pending_[i]);
+            }
+            window->frames++;
+            window->dropped += missed;
+        }
+    }
+    pending_.fill(0);
+    last_frame_ = now;
+    has_last_frame_ = true;
+
+    if (!dump_path_.empty() && now - interval_.start >= dump_interval_) {
+        dump();
+        clear(interval_);
+    }
+}
+
+void FrameStats::skip_frame() {
+    pending_.fill(0);
+    input_count_ = 0;
+    has_last_frame_ = false;
+}
+
+void FrameStats::reset() {
+    clear(total_);
+    clear(interval_);
+    pending_.fill(0);
+    input_count_ = 0;
+    has_last_frame_ = false;
+}
+
+void FrameStats::clear(Window& window) {
+    for (LatencyHistogram& phase : window.phases) {
+        phase.clear();
+    }
+    window.input_latency.clear();
+    window.frames = 0;
+    window.dropped = 0;
+    window.start = Clock::now();
+}
+
+void FrameStats::set_auto_dump(const std::string& path, double interval_s) {
+    dump_path_ = path;
+    dump_interval_ = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(interval_s));
+    clear(interval_);
+}
+
+FrameReport FrameStats::report(const Window& window) const {
+    FrameReport report;
+    report.timestamp_s = std::chrono::duration<double>(std::chrono::system_clock::now().time_since_epoch()).count();
+    report.elapsed_s = std::chrono::duration<double>(Clock::now() - window.start).count();
+    report.frames = window.frames;
+    report.dropped = window.dropped;
+    report.budget_ms = budget_ms();
+    const LatencyHistogram& frame = window.phases[static_cast<size_t>(FramePhase::FRAME)];
+    report.fps = frame.mean_ns() > 0 ? 1e9 / frame.mean_ns() : 0.0;
+    auto summarize = [](const char* name, const LatencyHistogram& h) {
+        return PhaseReport{name, h.count(), h.mean_ns() / 1e6, h.percentile_ns(50) / 1e6,
+                           h.percentile_ns(95) / 1e6, h.percentile_ns(99) / 1e6, h.max_ns() / 1e6};
+    };
+    for (size_t i = 0; i < window.phases.size(); ++i) {
+        report.phases.push_back(summarize(frame_phase_name(static_cast<FramePhase>(i)), window.phases[i]));
+    }
+    report.input_latency = summarize("input_latency", window.input_latency);
+    return report;
+}
+
+std::string FrameStats::to_csv(const FrameReport& report, bool header) {
+    std::string out;
+    if (header) {
+        out += "timestamp_s,elapsed_s,frames,dropped,budget_ms,fps,phase,count,mean_ms,p50_ms,p95_ms,p99_ms,max_ms\n";
+    }
+    char line[256];
+    std::vector<const PhaseReport*> rows;
+    for (const PhaseReport& phase : report.phases) {
+        rows.push_back(&phase);
+    }
+    rows.push_back(&report.input_latency);
+    for (const PhaseReport* row : rows) {
+        const PhaseReport& phase = *row;
+        std::snprintf(line, sizeof(line), "%.3f,%.3f,%llu,%llu,%.3f,%.2f,%s,%llu,%.4f,%.4f,%.4f,%.4f,%.4f\n",
+                      report.timestamp_s, report.elapsed_s, static_cast<unsigned long long>(report.frames),
+                      static_cast<unsigned long long>(report.dropped), report.budget_ms, report.fps,
+                      phase.phase.c_str(), static_cast<unsigned long long>(phase.count), phase.mean_ms,
+                      phase.p50_ms, phase.p95_ms, phase.p99_ms, phase.max_ms);
+        out += line;
+    }
+    return out;
+}
+
+std::string FrameStats::to_json(const FrameReport& report) {
+    char buffer[256];
+    std::snprintf(buffer, sizeof(buffer),
+                  "{\"timestamp_s\": %.3f, \"elapsed_s\": %.3f, \"frames\": %llu, \"dropped\": %llu, \"budget_ms\": %.3f, \"fps\": %.2f, \"phases\": {",
+                  report.timestamp_s, report.elapsed_s, static_cast<unsigned long long>(report.frames),
+                  static_cast<unsigned long long>(report.dropped), report.budget_ms, report.fps);
+    std::string out = buffer;
+    for (size_t i = 0; i < report.phases.size(); ++i) {
+        const PhaseReport& phase = report.phases[i];
+        std::snprintf(buffer, sizeof(buffer),
+                      "%s\"%s\": {\"count\": %llu, \"mean_ms\": %.4f, \"p50_ms\": %.4f, \"p95_ms\": %.4f, "
+                      "\"p99_ms\": %.4f, \"max_ms\": %.4f}",
+                      i ? ", " : "", phase.phase.c_str(), static_cast<unsigned long long>(phase.count),
+                      phase.mean_ms, phase.p50_ms, phase.p95_ms, phase.p99_ms, phase.max_ms);
+        out += buffer;
+    }
+    const PhaseReport& input = report.input_latency;
+    std::snprintf(buffer, sizeof(buffer),
+                  "}, \"input_latency\": {\"count\": %llu, \"mean_ms\": %.4f, \"p50_ms\": %.4f, \"p95_ms\": %.4f, "
+                  "\"p99_ms\": %.4f, \"max_ms\": %.4f}}\n",
+                  static_cast<unsigned long long>(input.count), input.mean_ms, input.p50_ms, input.p95_ms,
+                  input.p99_ms, input.max_ms);
+    out += buffer;
+    return out;
+}
+
+bool FrameStats::write_csv(const std::string& path) const {
+    std::ofstream file(path, std::ios::trunc);
+    file << to_csv(report());
+    return static_cast<bool>(file);
+}
+
+bool FrameStats::write_json(const std::string& path) const {
+    std::ofstream file(path, std::ios::trunc);
+    file << to_json(report());
+    return static_cast<bool>(file);
+}
+
+void FrameStats::dump() {
+    FrameReport last = report(interval_);
+    bool json = dump_path_.size() >= 5 && dump_path_.compare(dump_path_.size() - 5, 5, ".json") == 0;
+    if (json) {
+        std::ofstream file(dump_path_, std::ios::trunc);
+        file << to_json(last);
+        if (!file) {
+            ENGINE_LOG_WARN("Failed to write frame stats to {}", dump_path_);
+        }
+        return;
+    }
+    std::ifstream existing(dump_path_);
+    bool header = !existing || existing.peek() == std::ifstream::traits_type::eof();
+    existing.close();
+    std::ofstream file(dump_path_, std::ios::app);
+    file << to_csv(last, header);
+    if (!file) {
+        ENGINE_LOG_WARN("Failed to write frame stats to {}", dump_path_);
+    }
+}
+
+} // namespace platform
@@ -0,0 +1,183 @@
+#ifndef PLATFORM_FRAME_STATS_HPP
+#define PLATFORM_FRAME_STATS_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace platform {
+
+    enum class FramePhase {
+        POLL,   // Event::poll
+        UPDATE, // Game logic between polls and present
+        BUILD,  // present: batching / rasterizing the damaged areas
+        SUBMIT, // present: sending requests or images to the server
+        FLUSH,  // present: copying to the window and flushing
+        FRAME,  // Whole frame, present to present
+        COUNT
+    };
+
+    const char* frame_phase_name(FramePhase phase);
+
+    // Log-linear latency histogram in the style of HdrHistogram: 16 linear
+    // sub-buckets per power of two of microseconds, so every percentile is
+    // within ~6% of the recorded value, in a few KB with O(1) recording.
+    class LatencyHistogram {
+    public:
+        void record(uint64_t ns);
+        void clear();
+
+        uint64_t count() const { return count_; }
+        uint64_t max_ns() const { return max_ns_; }
+        double mean_ns() const { return count_ ? static_cast<double>(sum_ns_) / count_ : 0.0; }
+        // p in [0, 100]
+        uint64_t percentile_ns(double p) const;
+
+    private:
+        static constexpr size_t LINEAR = 32; // Exact buckets below 32 us
+        static constexpr size_t SUB = 16;
+        static constexpr size_t BUCKETS = LINEAR + 40 * SUB;
+
+        static size_t bucket_of(uint64_t us);
+        static uint64_t bucket_mid_ns(size_t bucket);
+
+        std::array<uint64_t, BUCKETS> buckets_{};
+        uint64_t count_ = 0;
+        uint64_t sum_ns_ = 0;
+        uint64_t max_ns_ = 0;
+    };
+
+    struct PhaseReport {
+        std::string phase;
+        uint64_t count;
+        double mean_ms, p50_ms, p95_ms, p99_ms, max_ms;
+    };
+
+    struct FrameReport {
+        double timestamp_s; // Unix time the report was taken
+        double elapsed_s;   // Wall time covered by the report
+        uint64_t frames;
+        uint64_t dropped;   // Refreshes skipped by slow frames, beyond the one each frame was due for
+        double budget_ms;
+        double fps;
+        std::vector<PhaseReport> phases; // Indexed by FramePhase
+        PhaseReport input_latency;       // Input arrival to the present that showed it
+    };
+
+    // Per-frame phase timing. Phase times are summed over a frame and
+    // recorded into one histogram per phase when the frame ends, next to
+    // the present-to-present frame time. Statistics accumulate until
+    // reset(); the optional periodic dump instead reports each interval on
+    // its own.
+    //
+    // Input-to-present latency: every key, button and scroll event handed
+    // to the game (by Event::poll or Event::capture) leaves its arrival
+    // time here, and the next end_frame() records how long ago that was.
+    // With Renderer confirmation on, end_frame() runs after an XSync, so
+    // the time includes the server executing the copy to the window.
+    class FrameStats {
+    public:
+        FrameStats();
+
+        void add(FramePhase phase, uint64_t ns) { pending_[static_cast<size_t>(phase)] += ns; }
+        // arrival_ns is CLOCK_MONOTONIC, as in InputEvent::arrival_ns
+        void add_input(uint64_t arrival_ns) {
+            if (input_count_ < inputs_.size()) {
+                inputs_[input_count_++] = arrival_ns;
+            }
+        }
+        // Called by Renderer::present().
+        void end_frame() { end_frame(std::chrono::steady_clock::now()); }
+        // Ends the frame as of `now`; for checks that feed exact frame times.
+        void end_frame(std::chrono::steady_clock::time_point now);
+        // Called instead when present() had nothing to do: the idle gap is
+        // not a frame, so the next frame time starts at the next present.
+        // Input consumed since the last present changed nothing on screen
+        // and is not counted.
+        void skip_frame();
+
+        void set_budget_ms(double budget_ms) { budget_ns_ = static_cast<uint64_t>(budget_ms * 1e6); }
+        double budget_ms() const { return budget_ns_ / 1e6; }
+
+        FrameReport report() const { return report(total_); }
+        void reset();
+
+        // Writes a report of the last interval every interval_s seconds.
+        // Paths ending in .json are overwritten with the latest report;
+        // anything else gets CSV rows appended. An empty path disables it.
+        void set_auto_dump(const std::string& path, double interval_s = 5.0);
+
+        static std::string to_csv(const FrameReport& report, bool header = true);
+        static std::string to_json(const FrameReport& report);
+        bool write_csv(const std::string& path) const;
+        bool write_json(const std::string& path) const;
+
+    private:
+        using Clock = std::chrono::steady_clock;
+
+        struct Window {
+            std::array<LatencyHistogram, static_cast<size_t>(FramePhase::COUNT)> phases;
+            LatencyHistogram input_latency;
+            uint64_t frames = 0;
+            uint64_t dropped = 0;
+            Clock::time_point start;
+        };
+
+        FrameReport report(const Window& window) const;
+        void clear(Window& window);
+        void dump();
+
+        std::array<uint64_t, static_cast<size_t>(FramePhase::COUNT)> pending_{};
+        // Arrival times of input consumed this frame; more than fit are
+        // ignored, the earliest (worst) ones are kept
+        std::array<uint64_t, 32> inputs_{};
+        size_t input_count_ = 0;
+        uint64_t budget_ns_;
+        Clock::time_point last_frame_;
+        bool has_last_frame_;
+        Window total_;
+        Window interval_;
+        std::string dump_path_;
+        Clock::duration dump_interval_;
+    };
+
+    // Adds the lifetime of the scope to a phase of the current frame.
+    class ScopeTimer {
+    public:
+        ScopeTimer(FrameStats& stats, FramePhase phase)
+            : stats_(stats), phase_(phase), start_(std::chrono::steady_clock::now()) {}
+        ~ScopeTimer() {
+            stats_.add(phase_, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start_).count()));
+        }
+        ScopeTimer(const ScopeTimer&) = delete;
+        ScopeTimer& operator=(const ScopeTimer&) = delete;
+
+    private:
+        FrameStats& stats_;
+        FramePhase phase_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+    // Splits a sequence of steps into consecutive phases: each lap() adds
+    // the time since the previous lap (or construction) to a phase.
+    class PhaseLaps {
+    public:
+        explicit PhaseLaps(FrameStats& stats) : stats_(stats), last_(std::chrono::steady_clock::now()) {}
+        void lap(FramePhase phase) {
+            std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+            stats_.add(phase, static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - last_).count()));
+            last_ = now;
+        }
+
+    private:
+        FrameStats& stats_;
+        std::chrono::steady_clock::time_point last_;
+    };
+
+} // namespace platform
+
+#endif // PLATFORM_FRAME_STATS_HPP
@@ -0,0 +1,21 @@
+#ifndef PLATFORM_FRAMEBUFFER_HPP
+#define PLATFORM_FRAMEBUFFER_HPP
+
+#include <cstdint>
+
+namespace platform {
+
+    // Client-side 32-bit pixel buffer. Pixels hold values already resolved
+    // for the target visual (see ColorResolver); stride is in pixels.
+    struct Framebuffer {
+        uint32_t* pixels = nullptr;
+        int width = 0;
+        int height = 0;
+        int stride = 0;
+
+        uint32_t* row(int y) const { return pixels + static_cast<long>(y) * stride; }
+    };
+
+} // namespace platform
+
+#endif // PLATFORM_FRAMEBUFFER_HPP
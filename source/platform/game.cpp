@@ -1,6 +1,6 @@
 #include "game.hpp"
+#include "profiler.hpp"
 #include <chrono>
-#include <thread>
 
 namespace platform {
 
@@ -8,42 +8,59 @@ namespace platform {
         : window_(std::make_unique<Window>(config)),
           renderer_(std::make_unique<Renderer>(*window_)),
           event_(std::make_unique<Event>(*window_)),
-          running_(true) {
+          scheduler_(*window_),
+          running_(true),
+          block_when_idle_(false),
+          idle_requested_(false) {
+        scheduler_.watch(event_->wake_fd());
         window_->show();
     }
 
-    void Game::add_object(std::shared_ptr<GameObject> obj) {
-        objects_.push_back(obj);
-        renderer_->add_object(obj);
-    }
-
-    void Game::set_event_callback(Event::EventCallback callback) {
-        event_->set_callback(callback);
-    }
-
     void Game::run() {
         auto last_frame = std::chrono::steady_clock::now();
+        // Whether the game allowed the last frame to be followed by sleep
+        bool may_idle = false;
         while (running_ && window_->should_run() == State::RUNNING) {
-            while (event_->poll()) {
+            bool idle = may_idle && renderer_->idle();
+            bool frame_due = scheduler_.wait(idle) == WakeReason::FRAME;
+            while (event_->poll(*renderer_)) {
                 if (event_->kind() == EventKind::EXIT || event_->kind() == EventKind::KEY_ESC) {
                     running_ = false;
+                } else {
+                    on_event(*event_);
                 }
             }
 
             auto now = std::chrono::steady_clock::now();
-            auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_frame).count();
-            if (delta >= 16) { // ~60 FPS
-                float delta_time = delta / 1000.0f;
-                update(delta_time);
-                for (auto& obj : objects_) {
-                    obj->update(delta_time);
-                }
-                renderer_->render();
-                last_frame = now;
+            if (idle && !frame_due) {
+                // Woken from idle by input: answer it with a frame right away
+                // and resume the simulation clock one step back, so update()
+                // runs once and can react to the input
+                timestep_.reset();
+                last_frame = now - std::chrono::ceil<std::chrono::steady_clock::duration>(
+                                       std::chrono::duration<double>(timestep_.step()));
+                frame_due = true;
+            }
+            if (!frame_due || !running_) {
+                continue;
             }
 
-            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            event_->capture(*renderer_);
+            idle_requested_ = false;
+            int steps;
+            {
+                ENGINE_PROFILE_ZONE("Game::update");
+                ScopeTimer timer(renderer_->frame_stats(), FramePhase::UPDATE);
+                steps = timestep_.advance(std::chrono::duration<double>(now - last_frame).count());
+                for (int i = 0; i < steps; ++i) {
+                    update(static_cast<float>(timestep_.step()));
+                }
+                interpolate(static_cast<float>(timestep_.alpha()));
+            }
+            renderer_->present();
+            last_frame = now;
+            may_idle = idle_requested_ || (block_when_idle_ && steps > 0);
         }
     }
 
-} // namespace platform
\ No newline at end of file
+} // namespace platform
@@ -4,25 +4,71 @@
 #include "window.hpp"
 #include "renderer.hpp"
 #include "event.hpp"
+#include "fixed_timestep.hpp"
+#include "frame_scheduler.hpp"
 #include <memory>
 
 namespace platform {
 
+    // Minimal game loop: sleeps until input or the next frame deadline and
+    // handles input as soon as it arrives. On each deadline it runs update()
+    // at a fixed simulation rate (120 Hz by default, independent of the
+    // frame rate), then interpolate() with the fraction of a step left over,
+    // then presents. A game whose scene is static can let the loop sleep
+    // until the next input instead of waking every frame (request_idle(),
+    // or set_block_when_idle()); simulation time spent asleep is not
+    // caught up, and the frame that answers the waking input runs one
+    // update() step. Subclasses draw through renderer(), advance their
+    // state in update() and move their shapes to the blended state in
+    // interpolate().
     class Game {
     public:
         Game(const WindowConfig& config);
-        void add_object(std::shared_ptr<GameObject> obj);
-        void set_event_callback(Event::EventCallback callback);
+        virtual ~Game() = default;
         void run();
+        void stop() { running_ = false; }
+        // Target frames per second, 60 by default; 0 runs unpaced.
+        void set_frame_rate(double rate_hz) { scheduler_.set_rate(rate_hz); }
+        // Simulation steps per second, and the most steps one frame may run
+        // to catch up after a stall.
+        void set_simulation_rate(double rate_hz) { timestep_.set_rate(rate_hz); }
+        void set_max_catch_up(int steps) { timestep_.set_max_steps(steps); }
+        // Off by default. When on, the loop sleeps until input whenever a
+        // frame ran update() and then presented nothing new; only for games
+        // whose update() has nothing to do without input (no timers, AI, or
+        // motion slower than a pixel per frame).
+        void set_block_when_idle(bool block) { block_when_idle_ = block; }
+        // Called from update() or interpolate(): the game is static until
+        // the next input, so if this frame presents nothing new the loop
+        // sleeps until input arrives. Applies to the current frame only.
+        void request_idle() { idle_requested_ = true; }
+        const FixedTimestep& timestep() const { return timestep_; }
+
+        Renderer& renderer() { return *renderer_; }
+        Event& event() { return *event_; }
+        // Input as of the start of this frame's update() calls
+        const InputSnapshot& input() const { return event_->input(); }
+        // Same as renderer().frame_stats()
+        FrameStats& frame_stats() { return renderer_->frame_stats(); }
+
     protected:
-        virtual void update(float delta_time) {}
+        // One simulation step of timestep().step() seconds
+        virtual void update(float step) { (void)step; }
+        // alpha in [0, 1) blends the previous step's state into the current.
+        virtual void interpolate(float alpha) { (void)alpha; }
+        // Called for every event other than EXIT / KEY_ESC.
+        virtual void on_event(const Event& event) { (void)event; }
+
         std::unique_ptr<Window> window_;
         std::unique_ptr<Renderer> renderer_;
         std::unique_ptr<Event> event_;
-        std::vector<std::shared_ptr<GameObject>> objects_;
+        FrameScheduler scheduler_;
+        FixedTimestep timestep_;
         bool running_;
+        bool block_when_idle_;
+        bool idle_requested_;
     };
 
 } // namespace platform
 
-#endif // PLATFORM_GAME_H
\ No newline at end of file
+#endif // PLATFORM_GAME_H
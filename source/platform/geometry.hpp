@@ -0,0 +1,35 @@
+#ifndef PLATFORM_GEOMETRY_HPP
+#define PLATFORM_GEOMETRY_HPP
+
+#include <algorithm>
+
+namespace platform {
+
+    // Axis-aligned pixel bounds, half-open: [x0, x1) x [y0, y1)
+    struct Bounds {
+        int x0, y0, x1, y1;
+
+        bool empty() const { return x0 >= x1 || y0 >= y1; }
+        long area() const { return empty() ? 0 : static_cast<long>(x1 - x0) * (y1 - y0); }
+        bool intersects(const Bounds& o) const {
+            return x0 < o.x1 && o.x0 < x1 && y0 < o.y1 && o.y0 < y1;
+        }
+        void merge(const Bounds& o) {
+            x0 = std::min(x0, o.x0);
+            y0 = std::min(y0, o.y0);
+            x1 = std::max(x1, o.x1);
+            y1 = std::max(y1, o.y1);
+        }
+        Bounds united(const Bounds& o) const {
+            Bounds b = *this;
+            b.merge(o);
+            return b;
+        }
+        Bounds clipped(int width, int height) const {
+            return Bounds{std::max(x0, 0), std::max(y0, 0), std::min(x1, width), std::min(y1, height)};
+        }
+    };
+
+} // namespace platform
+
+#endif // PLATFORM_GEOMETRY_HPP
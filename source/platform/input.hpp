@@ -0,0 +1,163 @@
+#ifndef PLATFORM_INPUT_HPP
+#define PLATFORM_INPUT_HPP
+
+#include "ring_buffer.hpp"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <time.h>
+
+namespace platform {
+
+    enum class EventKind {
+        EXIT,
+        NONE,
+        LEFT_CLICK,
+        RIGHT_CLICK,
+        MIDDLE_CLICK,
+        KEY_A,
+        KEY_ESC,
+        KEY_UP,
+        KEY_DOWN,
+        KEY_LEFT,
+        KEY_RIGHT,
+        KEY_SPACE,
+        EXPOSE
+    };
+
+    // Keys tracked in the key-state table. Anything else still arrives as
+    // an InputEvent (with its keysym) but has no state bit.
+    enum class Key : uint8_t {
+        UNKNOWN,
+        A, B, C, D, E, F, G, H, I, J, K, L, M,
+        N, O, P, Q, R, S, T, U, V, W, X, Y, Z,
+        NUM_0, NUM_1, NUM_2, NUM_3, NUM_4, NUM_5, NUM_6, NUM_7, NUM_8, NUM_9,
+        SPACE,
+        ESCAPE,
+        ENTER,
+        TAB,
+        BACKSPACE,
+        UP,
+        DOWN,
+        LEFT,
+        RIGHT,
+        LEFT_SHIFT,
+        RIGHT_SHIFT,
+        LEFT_CTRL,
+        RIGHT_CTRL,
+        LEFT_ALT,
+        RIGHT_ALT,
+        F1, F2, F3, F4, F5, F6, F7, F8, F9, F10, F11, F12,
+        COUNT
+    };
+
+    // One bit per Key
+    struct KeyBits {
+        static constexpr size_t WORDS = (static_cast<size_t>(Key::COUNT) + 63) / 64;
+
+        std::array<uint64_t, WORDS> words{};
+
+        bool test(Key key) const {
+            size_t bit = static_cast<size_t>(key);
+            return (words[bit / 64] >> (bit % 64)) & 1;
+        }
+        void set(Key key, bool on = true) {
+            size_t bit = static_cast<size_t>(key);
+            uint64_t mask = uint64_t(1) << (bit % 64);
+            words[bit / 64] = on ? (words[bit / 64] | mask) : (words[bit / 64] & ~mask);
+        }
+        bool any() const {
+            for (uint64_t word : words) {
+                if (word) {
+                    return true;
+                }
+            }
+            return false;
+        }
+        void clear() { words.fill(0); }
+    };
+
+    enum class MouseButton : uint8_t {
+        LEFT,
+        MIDDLE,
+        RIGHT
+    };
+
+    struct MouseState {
+        int x = 0;
+        int y = 0;
+        uint8_t buttons = 0;  // Held buttons, one bit per MouseButton
+        uint8_t pressed = 0;  // Went down since the previous snapshot
+        uint8_t released = 0; // Went up since the previous snapshot
+        int wheel = 0;        // Scroll notches since the previous snapshot, positive is up
+
+        static uint8_t bit(MouseButton button) { return static_cast<uint8_t>(1u << static_cast<unsigned>(button)); }
+        bool down(MouseButton button) const { return buttons & bit(button); }
+    };
+
+    enum class InputType : uint8_t {
+        KEY_PRESS,
+        KEY_RELEASE,
+        BUTTON_PRESS,
+        BUTTON_RELEASE,
+        MOTION, // Coalesced: one per run of consecutive pointer moves
+        SCROLL,
+        EXPOSE,
+        RESIZE, // New window size in width / height; coalesced like MOTION
+        CLOSE,
+        FOCUS_IN,
+        FOCUS_OUT
+    };
+
+    // Plain-old-data copy of one input event; nothing here refers back to
+    // Xlib, so update code can read it on any thread.
+    struct InputEvent {
+        InputType type = InputType::EXPOSE;
+        EventKind kind = EventKind::NONE; // Closest legacy kind, for Event::poll()
+        Key key = Key::UNKNOWN;
+        MouseButton button = MouseButton::LEFT;
+        bool repeat = false;   // Key auto-repeat
+        int x = 0;             // Pointer position, or the exposed area
+        int y = 0;
+        int width = 0;         // Exposed area or window size; height holds scroll steps for SCROLL
+        int height = 0;
+        uint32_t keysym = 0;
+        uint32_t time = 0;     // X server time in ms, 0 for injected events
+        uint64_t arrival_ns = 0; // CLOCK_MONOTONIC when read off the X connection or injected
+    };
+
+    inline uint64_t monotonic_ns() {
+        timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+    }
+
+    // Everything update code needs to know about input for one frame.
+    // Held state (keys, mouse.buttons, mouse position) is current as of the
+    // capture; edges (pressed_keys, released_keys, mouse.pressed/released,
+    // mouse.wheel) accumulate since the previous capture, so a tap that
+    // starts and ends between two frames still shows up in pressed().
+    struct InputSnapshot {
+        static constexpr size_t EVENT_CAPACITY = 256;
+
+        uint64_t frame = 0;
+        KeyBits keys;
+        KeyBits pressed_keys;
+        KeyBits released_keys;
+        MouseState mouse;
+        bool focused = true;
+        bool close_requested = false;
+        // Events not already handed out by Event::poll(), oldest first.
+        // Past EVENT_CAPACITY events are dropped (state is still tracked)
+        // and counted in events.overflowed().
+        RingBuffer<InputEvent, EVENT_CAPACITY> events;
+        uint64_t coalesced_motion = 0; // Motion events merged into an earlier one
+
+        bool down(Key key) const { return keys.test(key); }
+        bool pressed(Key key) const { return pressed_keys.test(key); }
+        bool released(Key key) const { return released_keys.test(key); }
+    };
+
+} // namespace platform
+
+#endif // PLATFORM_INPUT_HPP
\ No newline at end of file
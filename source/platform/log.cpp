@@ -0,0 +1,238 @@
+#include "log.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace platform {
+
+namespace {
+
+    using log_detail::Arg;
+    using log_detail::ArgKind;
+    using log_detail::Record;
+
+    // Single-producer/single-consumer ring owned by one logging thread and
+    // read only by the drain thread.
+    struct Ring {
+        static constexpr size_t CAPACITY = 512;
+
+        Record records[CAPACITY];
+        std::atomic<size_t> head{0}; // Next slot the producer writes
+        std::atomic<size_t> tail{0}; // Next slot the consumer reads
+        std::atomic<uint64_t> dropped{0};
+    };
+
+    const char* level_name(LogLevel level) {
+        switch (level) {
+        case LogLevel::TRACE: return "TRACE";
+        case LogLevel::DEBUG: return "DEBUG";
+        case LogLevel::INFO: return "INFO";
+        case LogLevel::WARN: return "WARN";
+        case LogLevel::ERROR: return "ERROR";
+        }
+        return "?";
+    }
+
+    void append_arg(std::string& out, const Record& record, const Arg& arg) {
+        char number[32];
+        switch (arg.kind) {
+        case ArgKind::INT:
+            std::snprintf(number, sizeof(number), "%lld", static_cast<long long>(arg.i));
+            break;
+        case ArgKind::UINT:
+            std::snprintf(number, sizeof(number), "%llu", static_cast<unsigned long long>(arg.u));
+            break;
+        case ArgKind::DOUBLE:
+            std::snprintf(number, sizeof(number), "%g", arg.d);
+            break;
+        case ArgKind::TEXT:
+            out.append(record.text + arg.text.offset, arg.text.length);
+            return;
+        }
+        out += number;
+    }
+
+    void format(std::string& out, const Record& record) {
+        char prefix[48];
+        std::snprintf(prefix, sizeof(prefix), "[%10.6f] [%s] ", record.time_ns * 1e-9, level_name(record.level));
+        out += prefix;
+        size_t next = 0;
+        for (const char* p = record.format; *p; ++p) {
+            if (p[0] == '{' && p[1] == '}' && next < record.arg_count) {
+                append_arg(out, record, record.args[next++]);
+                ++p;
+            } else {
+                out += *p;
+            }
+        }
+        out += '\n';
+    }
+
+    class Logger {
+    public:
+        static Logger& instance() {
+            static Logger logger;
+            return logger;
+        }
+
+        Ring& ring() {
+            thread_local Ring* ring = nullptr;
+            if (!ring) {
+                auto owned = std::make_unique<Ring>();
+                ring = owned.get();
+                std::lock_guard<std::mutex> lock(rings_mutex_);
+                rings_.push_back(std::move(owned));
+            }
+            return *ring;
+        }
+
+        uint64_t now() const {
+            return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start_).count());
+        }
+
+        bool flush() {
+            std::lock_guard<std::mutex> lock(drain_mutex_);
+            return drain();
+        }
+
+        // Called after a record is committed. Only takes the lock to wake
+        // the drain thread when it is asleep, i.e. when the rings were empty.
+        void committed() {
+            // Pairs with the fence in loop(): either the drain thread sees
+            // the record, or we see that it went to sleep
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (sleeping_.load(std::memory_order_relaxed) && sleeping_.exchange(false)) {
+                std::lock_guard<std::mutex> lock(wake_mutex_);
+                wake_.notify_one();
+            }
+        }
+
+        ~Logger() {
+            {
+                std::lock_guard<std::mutex> lock(wake_mutex_);
+                running_ = false;
+            }
+            wake_.notify_one();
+            thread_.join();
+            flush();
+        }
+
+    private:
+        Logger()
+            : start_(std::chrono::steady_clock::now()),
+              sleeping_(false),
+              running_(true),
+              thread_([this] { loop(); }) {}
+
+        // Drains until the rings are empty, then blocks without a timeout
+        // until a producer commits a record, so a process that logs
+        // nothing costs no wake-ups.
+        void loop() {
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            while (running_) {
+                sleeping_.store(true, std::memory_order_relaxed);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                lock.unlock();
+                bool wrote = flush();
+                lock.lock();
+                if (wrote) {
+                    sleeping_.store(false, std::memory_order_relaxed);
+                    continue;
+                }
+                wake_.wait(lock, [this] { return !sleeping_.load(std::memory_order_relaxed) || !running_; });
+            }
+        }
+
+        // Caller holds drain_mutex_.
+        bool drain() {
+            batch_.clear();
+            {
+                std::lock_guard<std::mutex> lock(rings_mutex_);
+                for (const auto& ring : rings_) {
+                    size_t tail = ring->tail.load(std::memory_order_relaxed);
+                    size_t head = ring->head.load(std::memory_order_acquire);
+                    for (; tail != head; ++tail) {
+                        batch_.push_back(ring->records[tail % Ring::CAPACITY]);
+                    }
+                    ring->tail.store(tail, std::memory_order_release);
+                    dropped_ += ring->dropped.exchange(0, std::memory_order_relaxed);
+                }
+            }
+            if (batch_.empty() && dropped_ == 0) {
+                return false;
+            }
+            // Interleave threads by time; each ring is already ordered.
+            std::stable_sort(batch_.begin(), batch_.end(),
+                             [](const Record& a, const Record& b) { return a.time_ns < b.time_ns; });
+            out_.clear();
+            err_.clear();
+            for (const Record& record : batch_) {
+                format(record.level >= LogLevel::WARN ? err_ : out_, record);
+            }
+            if (dropped_) {
+                err_ += "[WARN] Log rings full, dropped " + std::to_string(dropped_) + " records\n";
+                dropped_ = 0;
+            }
+            std::fwrite(out_.data(), 1, out_.size(), stdout);
+            std::fflush(stdout);
+            std::fwrite(err_.data(), 1, err_.size(), stderr);
+            return true;
+        }
+
+        std::chrono::steady_clock::time_point start_;
+        std::mutex rings_mutex_;
+        std::vector<std::unique_ptr<Ring>> rings_;
+        std::mutex drain_mutex_;
+        std::vector<Record> batch_;
+        std::string out_, err_;
+        uint64_t dropped_ = 0;
+        std::mutex wake_mutex_;
+        std::condition_variable wake_;
+        std::atomic<bool> sleeping_; // The drain thread found the rings empty
+        bool running_;
+        std::thread thread_; // Last, so it starts after everything above
+    };
+
+} // namespace
+
+namespace log_detail {
+
+    Record* begin(LogLevel level, const char* format) {
+        Logger& logger = Logger::instance();
+        Ring& ring = logger.ring();
+        size_t head = ring.head.load(std::memory_order_relaxed);
+        if (head - ring.tail.load(std::memory_order_acquire) >= Ring::CAPACITY) {
+            ring.dropped.fetch_add(1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        Record& record = ring.records[head % Ring::CAPACITY];
+        record.time_ns = logger.now();
+        record.format = format;
+        record.level = level;
+        record.arg_count = 0;
+        record.text_used = 0;
+        return &record;
+    }
+
+    void commit() {
+        // Only this thread moves head, so the relaxed load is current.
+        Logger& logger = Logger::instance();
+        Ring& ring = logger.ring();
+        ring.head.store(ring.head.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+        logger.committed();
+    }
+
+} // namespace log_detail
+
+void log_flush() {
+    Logger::instance().flush();
+}
+
+} // namespace platform
@@ -0,0 +1,152 @@
+#ifndef PLATFORM_LOG_HPP
+#define PLATFORM_LOG_HPP
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+
+// Compile-time log threshold: 0 TRACE, 1 DEBUG, 2 INFO, 3 WARN, 4 ERROR,
+// 5 OFF. Calls below it are dead code: the arguments are type-checked but
+// never evaluated, and the optimizer drops the call entirely.
+#ifndef ENGINE_LOG_LEVEL
+#define ENGINE_LOG_LEVEL 2
+#endif
+
+namespace platform {
+
+    enum class LogLevel : uint8_t {
+        TRACE,
+        DEBUG,
+        INFO,
+        WARN,
+        ERROR
+    };
+
+    namespace log_detail {
+
+        constexpr size_t MAX_ARGS = 8;
+        constexpr size_t TEXT_SIZE = 96;
+
+        enum class ArgKind : uint8_t { INT, UINT, DOUBLE, TEXT };
+
+        struct Arg {
+            ArgKind kind;
+            union {
+                int64_t i;
+                uint64_t u;
+                double d;
+                struct {
+                    uint16_t offset, length;
+                } text; // Slice of Record::text
+            };
+        };
+
+        // Binary log record. Only the format string pointer is kept (it must
+        // be a literal); string arguments are copied into `text`, numbers are
+        // stored raw. Formatting happens on the drain thread.
+        struct Record {
+            uint64_t time_ns;
+            const char* format;
+            LogLevel level;
+            uint8_t arg_count;
+            uint16_t text_used;
+            Arg args[MAX_ARGS];
+            char text[TEXT_SIZE];
+        };
+
+        // Slot in the calling thread's ring, or nullptr if the ring is full
+        // (the record is then counted as dropped). Never blocks.
+        Record* begin(LogLevel level, const char* format);
+        void commit();
+
+        template <typename T>
+        void capture(Record& record, const T& value) {
+            if (record.arg_count == MAX_ARGS) {
+                return;
+            }
+            Arg& arg = record.args[record.arg_count++];
+            if constexpr (std::is_floating_point<T>::value) {
+                arg.kind = ArgKind::DOUBLE;
+                arg.d = static_cast<double>(value);
+            } else if constexpr (std::is_integral<T>::value && std::is_signed<T>::value) {
+                arg.kind = ArgKind::INT;
+                arg.i = static_cast<int64_t>(value);
+            } else if constexpr (std::is_integral<T>::value || std::is_enum<T>::value) {
+                arg.kind = ArgKind::UINT;
+                arg.u = static_cast<uint64_t>(value);
+            } else {
+                const char* str;
+                size_t length;
+                if constexpr (std::is_same<T, std::string>::value) {
+                    str = value.data();
+                    length = value.size();
+                } else {
+                    str = value;
+                    length = str ? std::strlen(str) : 0;
+                }
+                length = std::min<size_t>(length, TEXT_SIZE - record.text_used);
+                std::memcpy(record.text + record.text_used, str, length);
+                arg.kind = ArgKind::TEXT;
+                arg.text.offset = record.text_used;
+                arg.text.length = static_cast<uint16_t>(length);
+                record.text_used += static_cast<uint16_t>(length);
+            }
+        }
+
+    } // namespace log_detail
+
+    // Queues a message for the background log thread. Each "{}" in `format`
+    // is replaced by the next argument. Use the ENGINE_LOG_* macros instead
+    // so that disabled levels compile out.
+    template <typename... Args>
+    void log_message(LogLevel level, const char* format, const Args&... args) {
+        log_detail::Record* record = log_detail::begin(level, format);
+        if (!record) {
+            return;
+        }
+        (log_detail::capture(*record, args), ...);
+        log_detail::commit();
+    }
+
+    // Writes out everything queued so far. Called at exit automatically.
+    void log_flush();
+
+} // namespace platform
+
+#define ENGINE_LOG_DISABLED(...)                   \
+    do {                                           \
+        if (false) {                               \
+            ::platform::log_message(::platform::LogLevel::TRACE, __VA_ARGS__); \
+        }                                          \
+    } while (0)
+
+#if ENGINE_LOG_LEVEL <= 0
+#define ENGINE_LOG_TRACE(...) ::platform::log_message(::platform::LogLevel::TRACE, __VA_ARGS__)
+#else
+#define ENGINE_LOG_TRACE(...) ENGINE_LOG_DISABLED(__VA_ARGS__)
+#endif
+#if ENGINE_LOG_LEVEL <= 1
+#define ENGINE_LOG_DEBUG(...) ::platform::log_message(::platform::LogLevel::DEBUG, __VA_ARGS__)
+#else
+#define ENGINE_LOG_DEBUG(...) ENGINE_LOG_DISABLED(__VA_ARGS__)
+#endif
+#if ENGINE_LOG_LEVEL <= 2
+#define ENGINE_LOG_INFO(...) ::platform::log_message(::platform::LogLevel::INFO, __VA_ARGS__)
+#else
+#define ENGINE_LOG_INFO(...) ENGINE_LOG_DISABLED(__VA_ARGS__)
+#endif
+#if ENGINE_LOG_LEVEL <= 3
+#define ENGINE_LOG_WARN(...) ::platform::log_message(::platform::LogLevel::WARN, __VA_ARGS__)
+#else
+#define ENGINE_LOG_WARN(...) ENGINE_LOG_DISABLED(__VA_ARGS__)
+#endif
+#if ENGINE_LOG_LEVEL <= 4
+#define ENGINE_LOG_ERROR(...) ::platform::log_message(::platform::LogLevel::ERROR, __VA_ARGS__)
+#else
+#define ENGINE_LOG_ERROR(...) ENGINE_LOG_DISABLED(__VA_ARGS__)
+#endif
+
+#endif // PLATFORM_LOG_HPP
@@ -0,0 +1,219 @@
+#include "profiler.hpp"
+#include "log.hpp"
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace platform {
+
+namespace {
+
+    struct Zone {
+        const char* name;
+        uint64_t start; // profiler_now() ticks
+        uint64_t end;
+    };
+
+    uint64_t steady_ns() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // Append-only zone storage owned by one thread. Zones are written into
+    // fixed chunks and published with a release store of the count, so a
+    // writer on another thread can read a consistent prefix without locks.
+    struct ThreadBuffer {
+        static constexpr size_t CHUNK = 4096;
+        static constexpr size_t MAX_CHUNKS = 256; // ~1M zones per thread
+
+        struct Chunk {
+            Zone zones[CHUNK];
+            std::atomic<size_t> count{0};
+        };
+
+        std::unique_ptr<Chunk> chunks[MAX_CHUNKS];
+        std::atomic<size_t> chunk_count{0};
+        uint32_t tid = 0;
+        std::string name;
+        uint64_t dropped = 0;
+
+        void push(const Zone& zone) {
+            size_t used = chunk_count.load(std::memory_order_relaxed);
+            Chunk* chunk = used ? chunks[used - 1].get() : nullptr;
+            if (!chunk || chunk->count.load(std::memory_order_relaxed) == CHUNK) {
+                if (used == MAX_CHUNKS) {
+                    dropped++;
+                    return;
+                }
+                chunks[used] = std::make_unique<Chunk>();
+                chunk = chunks[used].get();
+                chunk_count.store(used + 1, std::memory_order_release);
+            }
+            size_t n = chunk->count.load(std::memory_order_relaxed);
+            chunk->zones[n] = zone;
+            chunk->count.store(n + 1, std::memory_order_release);
+        }
+    };
+
+    class Profiler {
+    public:
+        static Profiler& instance() {
+            static Profiler profiler;
+            return profiler;
+        }
+
+        ThreadBuffer& buffer() {
+            thread_local ThreadBuffer* buffer = nullptr;
+            if (!buffer) {
+                std::lock_guard<std::mutex> lock(mutex_);
+                buffers_.push_back(std::make_unique<ThreadBuffer>());
+                buffer = buffers_.back().get();
+                buffer->tid = static_cast<uint32_t>(buffers_.size());
+                buffer->name = "thread " + std::to_string(buffer->tid);
+            }
+            return *buffer;
+        }
+
+        const char* intern(const std::string& name) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            return names_.insert(name).first->c_str();
+        }
+
+        void set_thread_name(const std::string& name) {
+            ThreadBuffer& own = buffer();
+            std::lock_guard<std::mutex> lock(mutex_);
+            own.name = name;
+        }
+
+        bool write(const std::string& path);
+
+        ~Profiler() {
+            const char* path = std::getenv("ENGINE_TRACE");
+            if (ENGINE_PROFILE && path) {
+                write(path);
+            }
+        }
+
+    private:
+        Profiler() : epoch_ticks_(profiler_now()), epoch_ns_(steady_ns()) {
+            // Make sure the logger exists first, so it outlives the write
+            // at exit.
+            log_flush();
+        }
+
+        // Ticks per nanosecond, from the ticks and steady time elapsed since
+        // the epoch; waits a little when too little time has passed.
+        double tick_rate() const;
+
+        uint64_t epoch_ticks_;
+        uint64_t epoch_ns_;
+        std::mutex mutex_;
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+        std::unordered_set<std::string> names_; // Node-based, so c_str() stays put
+    };
+
+    void write_escaped(std::string& out, const char* text) {
+        for (; *text; ++text) {
+            char c = *text;
+            if (c == '"' || c == '\\') {
+                out += '\\';
+                out += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                out += ' ';
+            } else {
+                out += c;
+            }
+        }
+    }
+
+    double Profiler::tick_rate() const {
+        uint64_t ns = steady_ns() - epoch_ns_;
+        if (ns < 10000000) {
+            std::this_thread::sleep_for(std::chrono::nanoseconds(10000000 - ns));
+        }
+        uint64_t ticks = profiler_now() - epoch_ticks_;
+        ns = steady_ns() - epoch_ns_;
+        return ns ? static_cast<double>(ticks) / ns : 1.0;
+    }
+
+    bool Profiler::write(const std::string& path) {
+        const double rate = tick_rate();
+        std::string out = "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [\n";
+        char number[128];
+        bool first = true;
+        std::lock_guard<std::mutex> lock(mutex_);
+        for (const auto& buffer : buffers_) {
+            out += first ? "" : ",\n";
+            first = false;
+            out += "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " + std::to_string(buffer->tid) +
+                   ", \"args\": {\"name\": \"";
+            write_escaped(out, buffer->name.c_str());
+            out += "\"}}";
+
+            size_t chunks = buffer->chunk_count.load(std::memory_order_acquire);
+            for (size_t c = 0; c < chunks; ++c) {
+                const ThreadBuffer::Chunk& chunk = *buffer->chunks[c];
+                size_t count = chunk.count.load(std::memory_order_acquire);
+                for (size_t i = 0; i < count; ++i) {
+                    const Zone& zone = chunk.zones[i];
+                    out += ",\n{\"name\": \"";
+                    write_escaped(out, zone.name);
+                    std::snprintf(number, sizeof(number),
+                                  "\", \"ph\": \"X\", \"pid\": 1, \"tid\": %u, \"ts\": %.3f, \"dur\": %.3f}",
+                                  buffer->tid, (static_cast<int64_t>(zone.start - epoch_ticks_) / rate) / 1e3,
+                                  ((zone.end - zone.start) / rate) / 1e3);
+                    out += number;
+                }
+            }
+            if (buffer->dropped) {
+                ENGINE_LOG_WARN("Profiler buffer of {} full, dropped {} zones", buffer->name, buffer->dropped);
+            }
+        }
+        out += "\n]}\n";
+
+        std::ofstream file(path, std::ios::trunc);
+        file << out;
+        if (!file) {
+            ENGINE_LOG_WARN("Failed to write trace to {}", path);
+            return false;
+        }
+        ENGINE_LOG_INFO("Wrote trace to {}", path);
+        return true;
+    }
+
+} // namespace
+
+void profiler_record(const char* name, uint64_t start, uint64_t end) {
+#if ENGINE_PROFILE
+    thread_local ThreadBuffer* buffer = &Profiler::instance().buffer();
+    buffer->push(Zone{name, start, end});
+#else
+    (void)name;
+    (void)start;
+    (void)end;
+#endif
+}
+
+const char* profiler_intern(const std::string& name) {
+    return Profiler::instance().intern(name);
+}
+
+void profiler_set_thread_name(const std::string& name) {
+    Profiler::instance().set_thread_name(name);
+}
+
+bool profiler_write(const std::string& path) {
+    return Profiler::instance().write(path);
+}
+
+bool profiler_enabled() {
+    return ENGINE_PROFILE != 0;
+}
+
+} // namespace platform
@@ -0,0 +1,69 @@
+#ifndef PLATFORM_PROFILER_HPP
+#define PLATFORM_PROFILER_HPP
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Zone profiler, compiled in with ENGINE_PROFILE=1. Without it the zone
+// macros expand to nothing and the functions below do nothing.
+#ifndef ENGINE_PROFILE
+#define ENGINE_PROFILE 0
+#endif
+
+namespace platform {
+
+    // Zone timestamp. On x86 this is the TSC, which costs about half a
+    // clock_gettime(); ticks are converted to time when the trace is written.
+    inline uint64_t profiler_now() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    // Appends a finished zone to the calling thread's buffer. `name` must
+    // outlive the profiler: a literal, or a string from profiler_intern().
+    void profiler_record(const char* name, uint64_t start, uint64_t end);
+    // Stable copy of a runtime name, e.g. for zones opened from Python.
+    const char* profiler_intern(const std::string& name);
+    // Names the calling thread in the trace.
+    void profiler_set_thread_name(const std::string& name);
+    // Writes everything recorded so far as Chrome trace_event JSON, loadable
+    // in Perfetto or chrome://tracing. Threads may keep recording meanwhile.
+    // If ENGINE_TRACE=<path> is set, this also happens at exit.
+    bool profiler_write(const std::string& path);
+    bool profiler_enabled();
+
+    class ProfileZone {
+    public:
+        explicit ProfileZone(const char* name) : name_(name), start_(profiler_now()) {}
+        ~ProfileZone() { profiler_record(name_, start_, profiler_now()); }
+        ProfileZone(const ProfileZone&) = delete;
+        ProfileZone& operator=(const ProfileZone&) = delete;
+
+    private:
+        const char* name_;
+        uint64_t start_;
+    };
+
+} // namespace platform
+
+#define ENGINE_PROFILE_CONCAT_(a, b) a##b
+#define ENGINE_PROFILE_CONCAT(a, b) ENGINE_PROFILE_CONCAT_(a, b)
+
+#if ENGINE_PROFILE
+// Times the rest of the enclosing scope under a literal name.
+#define ENGINE_PROFILE_ZONE(name) ::platform::ProfileZone ENGINE_PROFILE_CONCAT(profile_zone_, __LINE__)(name)
+#define ENGINE_PROFILE_FUNCTION() ENGINE_PROFILE_ZONE(__func__)
+#else
+#define ENGINE_PROFILE_ZONE(name) ((void)0)
+#define ENGINE_PROFILE_FUNCTION() ((void)0)
+#endif
+
+#endif // PLATFORM_PROFILER_HPP
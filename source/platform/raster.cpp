@@ -0,0 +1,305 @@
+#include "raster.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define PLATFORM_RASTER_X86 1
+#endif
+
+namespace platform {
+
+namespace {
+
+    using SpanFill = void (*)(uint32_t* dst, int count, uint32_t pixel);
+
+    void fill_span_scalar(uint32_t* dst, int count, uint32_t pixel) {
+        for (int i = 0; i < count; ++i) {
+            dst[i] = pixel;
+        }
+    }
+
+#ifdef PLATFORM_RASTER_X86
+    // Spans are usually short (sprite widths), so the vector paths use
+    // unaligned stores and finish with one store that overlaps the previous
+    // one instead of a scalar tail.
+    __attribute__((target("sse2")))
+    void fill_span_sse2(uint32_t* dst, int count, uint32_t pixel) {
+        if (count < 4) {
+            fill_span_scalar(dst, count, pixel);
+            return;
+        }
+        __m128i v = _mm_set1_epi32(static_cast<int>(pixel));
+        int i = 0;
+        for (; i + 4 <= count; i += 4) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), v);
+        }
+        if (i < count) {
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + count - 4), v);
+        }
+    }
+
+    __attribute__((target("avx2")))
+    void fill_span_avx2(uint32_t* dst, int count, uint32_t pixel) {
+        if (count < 8) {
+            fill_span_sse2(dst, count, pixel);
+            return;
+        }
+        __m256i v = _mm256_set1_epi32(static_cast<int>(pixel));
+        int i = 0;
+        for (; i + 8 <= count; i += 8) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), v);
+        }
+        if (i < count) {
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + count - 8), v);
+        }
+    }
+#endif
+
+    bool isa_supported(RasterIsa isa) {
+        switch (isa) {
+        case RasterIsa::SCALAR:
+            return true;
+#ifdef PLATFORM_RASTER_X86
+        case RasterIsa::SSE2:
+            return __builtin_cpu_supports("sse2");
+        case RasterIsa::AVX2:
+            return __builtin_cpu_supports("avx2");
+#else
+        default:
+            return false;
+#endif
+        }
+        return false;
+    }
+
+    SpanFill span_fill_for(RasterIsa isa) {
+        switch (isa) {
+#ifdef PLATFORM_RASTER_X86
+        case RasterIsa::AVX2:
+            return fill_span_avx2;
+        case RasterIsa::SSE2:
+            return fill_span_sse2;
+#endif
+        default:
+            return fill_span_scalar;
+        }
+    }
+
+    RasterIsa best_isa(RasterIsa limit) {
+        int level = static_cast<int>(limit);
+        while (level > 0 && !isa_supported(static_cast<RasterIsa>(level))) {
+            level--;
+        }
+        return static_cast<RasterIsa>(level);
+    }
+
+    RasterIsa current_isa = best_isa(RasterIsa::AVX2);
+    SpanFill fill_span = span_fill_for(current_isa);
+
+    // The helpers below take a clip that is already intersected with the
+    // framebuffer.
+
+    void fill_rect_clipped(const Framebuffer& fb, const Bounds& c, int x, int y, int width, int height, uint32_t pixel) {
+        int x0 = std::max(x, c.x0), x1 = std::min(x + width, c.x1);
+        int y0 = std::max(y, c.y0), y1 = std::min(y + height, c.y1);
+        if (x0 >= x1 || y0 >= y1) {
+            return;
+        }
+        for (int row = y0; row < y1; ++row) {
+            fill_span(fb.row(row) + x0, x1 - x0, pixel);
+        }
+    }
+
+    void outline_rect_clipped(const Framebuffer& fb, const Bounds& c, int x, int y, int width, int height, uint32_t pixel) {
+        // Matches XDrawRectangle: the outline covers x..x+width and y..y+height inclusive
+        fill_rect_clipped(fb, c, x, y, width + 1, 1, pixel);
+        fill_rect_clipped(fb, c, x, y + height, width + 1, 1, pixel);
+        fill_rect_clipped(fb, c, x, y + 1, 1, height - 1, pixel);
+        fill_rect_clipped(fb, c, x + width, y + 1, 1, height - 1, pixel);
+    }
+
+    void point_clipped(const Framebuffer& fb, const Bounds& c, int x, int y, uint32_t pixel) {
+        if (static_cast<unsigned>(x - c.x0) < static_cast<unsigned>(c.x1 - c.x0) &&
+            static_cast<unsigned>(y - c.y0) < static_cast<unsigned>(c.y1 - c.y0)) {
+            fb.row(y)[x] = pixel;
+        }
+    }
+
+    int64_t floor_div(int64_t a, int64_t b) {
+        int64_t q = a / b;
+        return (a % b != 0 && ((a < 0) != (b < 0))) ? q - 1 : q;
+    }
+
+    int64_t ceil_div(int64_t a, int64_t b) {
+        return -floor_div(-a, b);
+    }
+
+    // Midpoint line stepped along its major axis. Step i lands on
+    // major = m0 + i * sm and minor = n0 + sn * floor((2 * i * dn + dm) / (2 * dm)),
+    // which lets the visible step range be computed up front: only steps
+    // inside the clip are visited and the pixels are the same as for an
+    // unclipped walk.
+    void line_clipped(const Framebuffer& fb, const Bounds& c, int x1, int y1, int x2, int y2, uint32_t pixel) {
+        bool x_major = std::abs(x2 - x1) >= std::abs(y2 - y1);
+        int m0 = x_major ? x1 : y1, n0 = x_major ? y1 : x1;
+        int64_t dm = std::abs(x_major ? x2 - x1 : y2 - y1);
+        int64_t dn = std::abs(x_major ? y2 - y1 : x2 - x1);
+        int sm = (x_major ? x2 >= x1 : y2 >= y1) ? 1 : -1;
+        int sn = (x_major ? y2 >= y1 : x2 >= x1) ? 1 : -1;
+        int cm0 = x_major ? c.x0 : c.y0, cm1 = x_major ? c.x1 : c.y1;
+        int cn0 = x_major ? c.y0 : c.x0, cn1 = x_major ? c.y1 : c.x1;
+
+        if (dm == 0) {
+            point_clipped(fb, c, x1, y1, pixel);
+            return;
+        }
+
+        // Steps whose major coordinate is inside [cm0, cm1)
+        int64_t lo = 0, hi = dm;
+        if (sm > 0) {
+            lo = std::max<int64_t>(lo, cm0 - m0);
+            hi = std::min<int64_t>(hi, cm1 - 1 - m0);
+        } else {
+            lo = std::max<int64_t>(lo, m0 - (cm1 - 1));
+            hi = std::min<int64_t>(hi, m0 - cm0);
+        }
+        // Steps whose minor offset k = floor((2 i dn + dm) / (2 dm)) keeps
+        // the minor coordinate inside [cn0, cn1). k >= a  <=>  i >= ceil((2a - 1) dm / (2 dn)),
+        // and k <= b  <=>  i <= floor(((2b + 1) dm - 1) / (2 dn)).
+        int64_t k_lo = sn > 0 ? cn0 - n0 : n0 - (cn1 - 1);
+        int64_t k_hi = sn > 0 ? cn1 - 1 - n0 : n0 - cn0;
+        if (k_hi < 0 || k_lo > dn) {
+            return;
+        }
+        if (dn > 0) {
+            if (k_lo > 0) {
+                lo = std::max(lo, ceil_div((2 * k_lo - 1) * dm, 2 * dn));
+            }
+            hi = std::min(hi, floor_div((2 * k_hi + 1) * dm - 1, 2 * dn));
+        } else if (k_lo > 0) {
+            return;
+        }
+        if (lo > hi) {
+            return;
+        }
+
+        int64_t num = 2 * lo * dn + dm;
+        int64_t k = floor_div(num, 2 * dm);
+        int64_t err = num - k * 2 * dm; // Remainder in [0, 2 dm)
+        int m = m0 + static_cast<int>(lo) * sm;
+        int n = n0 + static_cast<int>(k) * sn;
+        for (int64_t i = lo; i <= hi; ++i) {
+            if (x_major) {
+                fb.row(n)[m] = pixel;
+            } else {
+                fb.row(m)[n] = pixel;
+            }
+            m += sm;
+            err += 2 * dn;
+            if (err >= 2 * dm) {
+                err -= 2 * dm;
+                n += sn;
+            }
+        }
+    }
+
+} // namespace
+
+RasterIsa raster_isa() {
+    return current_isa;
+}
+
+RasterIsa raster_select_isa(RasterIsa isa) {
+    current_isa = best_isa(isa);
+    fill_span = span_fill_for(current_isa);
+    return current_isa;
+}
+
+const char* raster_isa_name(RasterIsa isa) {
+    switch (isa) {
+    case RasterIsa::SSE2:
+        return "sse2";
+    case RasterIsa::AVX2:
+        return "avx2";
+    default:
+        return "scalar";
+    }
+}
+
+void raster_fill_rect(const Framebuffer& fb, const Bounds& clip, int x, int y, int width, int height, uint32_t pixel) {
+    fill_rect_clipped(fb, clip.clipped(fb.width, fb.height), x, y, width, height, pixel);
+}
+
+void raster_outline_rect(const Framebuffer& fb, const Bounds& clip, int x, int y, int width, int height, uint32_t pixel) {
+    outline_rect_clipped(fb, clip.clipped(fb.width, fb.height), x, y, width, height, pixel);
+}
+
+void raster_point(const Framebuffer& fb, const Bounds& clip, int x, int y, uint32_t pixel) {
+    point_clipped(fb, clip.clipped(fb.width, fb.height), x, y, pixel);
+}
+
+void raster_line(const Framebuffer& fb, const Bounds& clip, int x1, int y1, int x2, int y2, uint32_t pixel) {
+    Bounds c = clip.clipped(fb.width, fb.height);
+    if (!c.empty()) {
+        line_clipped(fb, c, x1, y1, x2, y2, pixel);
+    }
+}
+
+namespace {
+
+    void draw_row(const Framebuffer& fb, const ShapeStore& store, uint32_t row, const Bounds& c) {
+        const ShapeColumns& cols = store.columns();
+        int x = cols.x[row], y = cols.y[row];
+        uint32_t pixel = static_cast<uint32_t>(store.palette()[cols.color[row]].x11_color);
+        switch (cols.kind[row]) {
+        case ShapeKind::POINT:
+            point_clipped(fb, c, x, y, pixel);
+            break;
+        case ShapeKind::LINE:
+            if (store.bounds(row).intersects(c)) {
+                line_clipped(fb, c, x, y, x + cols.w[row], y + cols.h[row], pixel);
+            }
+            break;
+        case ShapeKind::RECT:
+            if (cols.flags[row] & ShapeStore::FILLED) {
+                fill_rect_clipped(fb, c, x, y, cols.w[row], cols.h[row], pixel);
+            } else if (store.bounds(row).intersects(c)) {
+                outline_rect_clipped(fb, c, x, y, cols.w[row], cols.h[row], pixel);
+            }
+            break;
+        }
+    }
+
+} // namespace
+
+void raster_scene(const Framebuffer& fb, const ShapeStore& store, const Bounds& clip, uint32_t background) {
+    Bounds c = clip.clipped(fb.width, fb.height);
+    if (c.empty()) {
+        return;
+    }
+    fill_rect_clipped(fb, c, c.x0, c.y0, c.x1 - c.x0, c.y1 - c.y0, background);
+
+    const std::vector<uint8_t>& flags = store.columns().flags;
+    const size_t rows = store.rows();
+    for (size_t i = 0; i < rows; ++i) {
+        if (flags[i] & ShapeStore::VISIBLE) {
+            draw_row(fb, store, static_cast<uint32_t>(i), c);
+        }
+    }
+}
+
+void raster_rows(const Framebuffer& fb, const ShapeStore& store, const uint32_t* rows, size_t count,
+                 const Bounds& clip, uint32_t background) {
+    Bounds c = clip.clipped(fb.width, fb.height);
+    if (c.empty()) {
+        return;
+    }
+    fill_rect_clipped(fb, c, c.x0, c.y0, c.x1 - c.x0, c.y1 - c.y0, background);
+    for (size_t i = 0; i < count; ++i) {
+        draw_row(fb, store, rows[i], c);
+    }
+}
+
+} // namespace platform
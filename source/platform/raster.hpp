@@ -0,0 +1,42 @@
+#ifndef PLATFORM_RASTER_HPP
+#define PLATFORM_RASTER_HPP
+
+#include "framebuffer.hpp"
+#include "geometry.hpp"
+#include "shape_store.hpp"
+#include <cstddef>
+#include <cstdint>
+
+namespace platform {
+
+    // Instruction sets the span fills can use. The best one the CPU supports
+    // is picked at startup; every path produces identical pixels.
+    enum class RasterIsa {
+        SCALAR,
+        SSE2,
+        AVX2
+    };
+
+    RasterIsa raster_isa();
+    // Switches to isa, or the best supported one below it. Returns the ISA in use.
+    RasterIsa raster_select_isa(RasterIsa isa);
+    const char* raster_isa_name(RasterIsa isa);
+
+    // CPU rasterization of retained shapes. Every call is clipped to both
+    // the framebuffer and the given clip bounds, so a scene can be redrawn
+    // one damaged rectangle at a time with the same result.
+    void raster_fill_rect(const Framebuffer& fb, const Bounds& clip, int x, int y, int width, int height, uint32_t pixel);
+    void raster_outline_rect(const Framebuffer& fb, const Bounds& clip, int x, int y, int width, int height, uint32_t pixel);
+    void raster_line(const Framebuffer& fb, const Bounds& clip, int x1, int y1, int x2, int y2, uint32_t pixel);
+    void raster_point(const Framebuffer& fb, const Bounds& clip, int x, int y, uint32_t pixel);
+
+    // Fills clip with the background and draws every visible shape that
+    // intersects it, in painter's order.
+    void raster_scene(const Framebuffer& fb, const ShapeStore& store, const Bounds& clip, uint32_t background);
+    // Same, for a pre-selected list of visible rows in draw order.
+    void raster_rows(const Framebuffer& fb, const ShapeStore& store, const uint32_t* rows, size_t count,
+                     const Bounds& clip, uint32_t background);
+
+} // namespace platform
+
+#endif // PLATFORM_RASTER_HPP
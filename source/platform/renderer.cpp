@@ -1,125 +1,742 @@
 #include "renderer.hpp"
+#include "input.hpp"
+#include "log.hpp"
+#include "profiler.hpp"
+#include "raster.hpp"
+#include "x_traffic.hpp"
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
 #include <algorithm>
-#include <iostream>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <time.h>
+#include <unistd.h>
 
 namespace platform {
 
-void Color::allocate(Display* dpy, Colormap cmap) {
-    XColor xcolor;
-    xcolor.red = r << 8;
-    xcolor.green = g << 8;
-    xcolor.blue = b << 8;
-    xcolor.flags = DoRed | DoGreen | DoBlue;
-    if (XAllocColor(dpy, cmap, &xcolor)) {
-        x11_color = xcolor.pixel;
-        std::cout << "Allocated color RGB(" << (int)r << "," << (int)g << "," << (int)b << ") = " << x11_color << std::endl;
-    } else {
-        std::cerr << "Failed to allocate color RGB(" << (int)r << "," << (int)g << "," << (int)b << ")" << std::endl;
-        x11_color = WhitePixel(dpy, DefaultScreen(dpy));
+namespace {
+
+    size_t render_threads() {
+        const char* env = std::getenv("ENGINE_RENDER_THREADS");
+        long threads = env ? std::strtol(env, nullptr, 10) : 1;
+        return threads > 0 ? static_cast<size_t>(threads) : 1;
+    }
+
+    bool confirm_requested() {
+        const char* env = std::getenv("ENGINE_CONFIRM_PRESENT");
+        return env && std::strtol(env, nullptr, 10) != 0;
+    }
+
+    // CLOCK_MONOTONIC time the process started, or 0 if unknown. The
+    // kernel only keeps it in clock ticks since boot.
+    uint64_t process_start_ns() {
+        std::ifstream file("/proc/self/stat");
+        std::string stat;
+        std::getline(file, stat);
+        // Fields count from after the command name, which may hold spaces
+        size_t name_end = stat.rfind(')');
+        if (name_end == std::string::npos) {
+            return 0;
+        }
+        std::istringstream fields(stat.substr(name_end + 1));
+        std::string field;
+        for (int i = 3; i <= 22 && fields >> field; ++i) {
+        }
+        unsigned long long ticks = std::strtoull(field.c_str(), nullptr, 10);
+        long hz = sysconf(_SC_CLK_TCK);
+        timespec boot;
+        if (!ticks || hz <= 0 || clock_gettime(CLOCK_BOOTTIME, &boot) != 0) {
+            return 0;
+        }
+        uint64_t boot_ns = static_cast<uint64_t>(boot.tv_sec) * 1000000000ull + static_cast<uint64_t>(boot.tv_nsec);
+        uint64_t age = boot_ns - ticks * (1000000000ull / static_cast<uint64_t>(hz));
+        uint64_t now = monotonic_ns();
+        return now > age ? now - age : 0;
+    }
+
+    // Back buffer headroom: growing past the buffer allocates a quarter
+    // more than the window needs, and it is only given back once the
+    // window covers less than a quarter of it
+    constexpr int GROW_HEADROOM = 4;
+    constexpr long SHRINK_AREA_RATIO = 4;
+
+    int with_headroom(int size, int limit) {
+        return std::max(size, std::min(size + size / GROW_HEADROOM, limit));
     }
-}
 
-Renderer::Renderer(const Window& window)
-    : dpy_(window.get_display()),
+    // Copies come from our own back buffer, which is never obscured, so the
+    // GraphicsExpose / NoExpose event each XCopyArea would send is only a
+    // spurious wake-up
+    GC create_gc(Display* dpy, ::Window window) {
+        XGCValues values;
+        values.graphics_exposures = False;
+        return XCreateGC(dpy, window, GCGraphicsExposures, &values);
+    }
+
+    Bool is_configure_event(Display*, XEvent* event, XPointer window) {
+        return (event->type == MapNotify || event->type == ConfigureNotify) &&
+               event->xany.window == *reinterpret_cast<::Window*>(window);
+    }
+
+    // Outcome of an in-place shape edit
+    enum class Edit {
+        REJECTED,  // Not applicable to this shape
+        UNCHANGED, // Already in the requested state
+        CHANGED
+    };
+
+} // namespace
+
+Renderer::Renderer(const Window& window, RenderMode mode)
+    : window_(window),
+      mode_(window.is_headless() || window.is_xcb() ? RenderMode::SOFTWARE : mode),
+      dpy_(window.get_display()),
       wd_(window.get_window()),
-      width_(800),
-      height_(600),
-      cmap_(DefaultColormap(dpy_, DefaultScreen(dpy_))),
-      gc_(DefaultGC(dpy_, DefaultScreen(dpy_))),
-      draw_color_{255, 255, 255, 255, 0} {
+      buffer_(0),
+      width_(window.width()),
+      height_(window.height()),
+      buffer_width_(0),
+      buffer_height_(0),
+      gc_(dpy_ ? create_gc(dpy_, wd_) : nullptr),
+      colors_(dpy_),
+      draw_color_{255, 255, 255, 255, 0},
+      background_pixel_(0),
+      tiles_(render_threads()),
+      confirm_present_(confirm_requested()),
+      backbuffer_ready_(!dpy_),
+      configured_(!dpy_),
+      configured_ns_(dpy_ ? 0 : window.created_ns()),
+      first_frame_ns_(0),
+      dirty_(true),
+      generation_(1),
+      presented_generation_(0),
+      idle_(false) {
+    draw_color_.x11_color = colors_.resolve(draw_color_.r, draw_color_.g, draw_color_.b);
+    background_pixel_ = draw_color_.x11_color;
+    damage_.add_all();
+    if (ENGINE_PROFILE) {
+        profiler_set_thread_name("render");
+    }
+    if (const char* stats_path = std::getenv("ENGINE_FRAME_STATS")) {
+        frame_stats_.set_auto_dump(stats_path);
+    }
+    if (!dpy_) {
+        allocate_backbuffer(width_, height_);
+        if (window.is_xcb()) {
+            xcb_surface_ = std::make_unique<XcbSurface>(window);
+            ENGINE_LOG_INFO("Initialized XCB software renderer with buffer size {}x{}", width_, height_);
+        } else {
+            ENGINE_LOG_INFO("Initialized headless renderer with buffer size {}x{}", width_, height_);
+        }
+        return;
+    }
+
     XSetErrorHandler([](Display* dpy, XErrorEvent* e) {
         char msg[256];
         XGetErrorText(dpy, e->error_code, msg, sizeof(msg));
-        std::cerr << "X11 Error: " << msg << " (code: " << (int)e->error_code << ")" << std::endl;
+        ENGINE_LOG_ERROR("X11 Error: {} (code: {})", msg, e->error_code);
         return 0;
     });
-    draw_color_.allocate(dpy_, cmap_);
-    buffer_ = XCreatePixmap(dpy_, wd_, width_, height_, DefaultDepth(dpy_, DefaultScreen(dpy_)));
-    if (!buffer_) {
-        std::cerr << "Failed to create pixmap" << std::endl;
+    ENGINE_LOG_INFO("Initialized renderer; back buffer deferred until the window is mapped");
+}
+
+bool Renderer::create_backbuffer() {
+    if (!configured_) {
+        if (!window_.shown()) {
+            return false;
+        }
+        // The map is in flight; the event stays queued for Event
+        ENGINE_X_CALL(dpy_, "Renderer::create_backbuffer XPeekIfEvent");
+        XEvent event;
+        XPeekIfEvent(dpy_, &event, is_configure_event, reinterpret_cast<XPointer>(&wd_));
+        handle_event(event);
+    }
+    allocate_backbuffer(width_, height_);
+    if (mode_ == RenderMode::SOFTWARE) {
+        ENGINE_LOG_INFO("Software rasterizer using {} span fills on {} thread(s)", raster_isa_name(raster_isa()),
+                        tiles_.thread_count());
+    }
+    backbuffer_ready_ = true;
+    ENGINE_LOG_INFO("Created back buffer with size {}x{}", width_, height_);
+    return true;
+}
+
+void Renderer::fit_backbuffer() {
+    bool outgrown = width_ > buffer_width_ || height_ > buffer_height_;
+    bool oversized = static_cast<long>(width_) * height_ * SHRINK_AREA_RATIO <
+                     static_cast<long>(buffer_width_) * buffer_height_;
+    if (!outgrown && !oversized) {
+        return;
+    }
+    int max_width = width_ + width_ / GROW_HEADROOM;
+    int max_height = height_ + height_ / GROW_HEADROOM;
+    if (dpy_) {
+        max_width = DisplayWidth(dpy_, DefaultScreen(dpy_));
+        max_height = DisplayHeight(dpy_, DefaultScreen(dpy_));
+    } else if (window_.is_xcb()) {
+        max_width = window_.get_xcb_screen()->width_in_pixels;
+        max_height = window_.get_xcb_screen()->height_in_pixels;
     }
-    XSetForeground(dpy_, gc_, draw_color_.x11_color);
-    XFillRectangle(dpy_, buffer_, gc_, 0, 0, width_, height_);
-    std::cout << "Initialized renderer with buffer size " << width_ << "x" << height_ << std::endl;
+    int width = with_headroom(width_, max_width);
+    int height = with_headroom(height_, max_height);
+    ENGINE_LOG_INFO("Reallocating back buffer from {}x{} to {}x{} for a {}x{} window", buffer_width_, buffer_height_,
+                    width, height, width_, height_);
+    allocate_backbuffer(width, height);
+}
+
+// Whatever the old buffer held is gone, so the next frame repaints everything
+void Renderer::allocate_backbuffer(int width, int height) {
+    if (!dpy_) {
+        // A fresh vector, so shrinking gives the memory back
+        std::vector<uint32_t>(static_cast<size_t>(width) * height, static_cast<uint32_t>(background_pixel_)).swap(memory_);
+    } else if (mode_ == RenderMode::SOFTWARE) {
+        // Waits for the server to finish with the old segments first
+        surface_.reset();
+        surface_ = std::make_unique<ShmSurface>(dpy_, width, height);
+    } else {
+        ENGINE_X_CALL(dpy_, "Renderer::allocate_backbuffer XCreatePixmap");
+        if (buffer_) {
+            XFreePixmap(dpy_, buffer_);
+        }
+        buffer_ = XCreatePixmap(dpy_, wd_, width, height, DefaultDepth(dpy_, DefaultScreen(dpy_)));
+        if (!buffer_) {
+            ENGINE_LOG_ERROR("Failed to create pixmap");
+        }
+    }
+    buffer_width_ = width;
+    buffer_height_ = height;
+    previous_repaint_.clear();
+    damage_.add_all();
+}
+
+void Renderer::resize(int width, int height) {
+    width = std::max(width, 1);
+    height = std::max(height, 1);
+    if (width == width_ && height == height_) {
+        return;
+    }
+    // The back buffer still holds the rest of the frame
+    if (width > width_) {
+        damage_.add(Bounds{width_, 0, width, height});
+    }
+    if (height > height_) {
+        damage_.add(Bounds{0, height_, width, height});
+    }
+    width_ = width;
+    height_ = height;
+    generation_++;
+    ENGINE_LOG_DEBUG("Window resized to {}x{}", width, height);
+}
+
+StartupReport Renderer::startup() const {
+    uint64_t created = window_.created_ns();
+    uint64_t process = process_start_ns();
+    auto ms = [](uint64_t from, uint64_t to) { return from && to >= from ? (to - from) / 1e6 : -1.0; };
+    return StartupReport{ms(process, created), configured_ ? ms(created, configured_ns_) : -1.0,
+                         ms(created, first_frame_ns_), first_frame_ns_ ? ms(process, first_frame_ns_) : -1.0};
 }
 
 Renderer::~Renderer() {
+    surface_.reset();
     if (buffer_) {
         XFreePixmap(dpy_, buffer_);
     }
+    if (gc_) {
+        XFreeGC(dpy_, gc_);
+    }
+}
+
+std::vector<uint32_t> Renderer::read_pixels() const {
+    std::vector<uint32_t> pixels(static_cast<size_t>(width_) * height_);
+    if (!backbuffer_ready_) {
+        return pixels;
+    }
+    // A window that grew since the last present may not fit the buffer yet
+    int width = std::min(width_, buffer_width_);
+    int height = std::min(height_, buffer_height_);
+    if (mode_ == RenderMode::SOFTWARE) {
+        Framebuffer fb = surface_ ? surface_->front()
+                                  : Framebuffer{const_cast<uint32_t*>(memory_.data()), width, height, buffer_width_};
+        for (int y = 0; y < height; ++y) {
+            std::copy(fb.row(y), fb.row(y) + width, pixels.begin() + static_cast<size_t>(y) * width_);
+        }
+        return pixels;
+    }
+    XImage* image;
+    {
+        ENGINE_X_CALL(dpy_, "Renderer::read_pixels XGetImage");
+        image = XGetImage(dpy_, buffer_, 0, 0, width, height, AllPlanes, ZPixmap);
+    }
+    if (!image) {
+        return pixels;
+    }
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            pixels[static_cast<size_t>(y) * width_ + x] = static_cast<uint32_t>(XGetPixel(image, x, y));
+        }
+    }
+    XDestroyImage(image);
+    return pixels;
+}
+
+uint32_t Renderer::read_pixel(int x, int y) const {
+    if (x < 0 || y < 0 || x >= width_ || y >= height_ || !backbuffer_ready_) {
+        return 0;
+    }
+    if (mode_ == RenderMode::SOFTWARE) {
+        if (x >= buffer_width_ || y >= buffer_height_) {
+            return 0;
+        }
+        Framebuffer fb = surface_ ? surface_->front()
+                                  : Framebuffer{const_cast<uint32_t*>(memory_.data()), width_, height_, buffer_width_};
+        return fb.row(y)[x];
+    }
+    return read_pixels()[static_cast<size_t>(y) * width_ + x];
+}
+
+bool Renderer::handle_event(const XEvent& event) {
+    if ((event.type == MapNotify || event.type == ConfigureNotify) && event.xany.window == wd_) {
+        // Later resizes reach resize() through Event; this one may have
+        // been peeked at by create_backbuffer(), before Event sees it
+        if (event.type == ConfigureNotify && !backbuffer_ready_) {
+            resize(event.xconfigure.width, event.xconfigure.height);
+        }
+        if (!configured_) {
+            configured_ = true;
+            configured_ns_ = monotonic_ns();
+        }
+        return false;
+    }
+    return surface_ && surface_->handle_event(event);
 }
 
 void Renderer::set_draw_color(unsigned char r, unsigned char g, unsigned char b, unsigned char a) {
-    draw_color_ = {r, g, b, a, 0};
-    draw_color_.allocate(dpy_, cmap_);
+    draw_color_ = {r, g, b, a, colors_.resolve(r, g, b)};
 }
 
 void Renderer::clear() {
-    shapes_.clear();
-    XSetForeground(dpy_, gc_, draw_color_.x11_color);
-    XFillRectangle(dpy_, buffer_, gc_, 0, 0, width_, height_);
-    std::cout << "Cleared shapes" << std::endl;
+    store_.clear();
+    damage_.add_all();
+    touch();
+    ENGINE_LOG_DEBUG("Cleared shapes");
 }
 
-void Renderer::draw_point(int x, int y, int id) {
-    shapes_.push_back(Point{x, y, draw_color_, id});
-    XSetForeground(dpy_, gc_, draw_color_.x11_color);
-    XDrawPoint(dpy_, buffer_, gc_, x, y);
-    std::cout << "Drew point at (" << x << "," << y << ") with id " << id << std::endl;
+ShapeHandle Renderer::draw_point(int x, int y, int id) {
+    ShapeHandle handle = store_.add(ShapeKind::POINT, x, y, 0, 0, false, store_.intern_color(draw_color_), id);
+    damage_row(store_.row(handle));
+    touch();
+    ENGINE_LOG_TRACE("Drew point at ({},{}) with id {}", x, y, id);
+    return handle;
 }
 
-void Renderer::draw_line(int x1, int y1, int x2, int y2, int id) {
-    shapes_.push_back(Line{x1, y1, x2, y2, draw_color_, id});
-    XSetForeground(dpy_, gc_, draw_color_.x11_color);
-    XDrawLine(dpy_, buffer_, gc_, x1, y1, x2, y2);
-    std::cout << "Drew line from (" << x1 << "," << y1 << ") to (" << x2 << "," << y2 << ") with id " << id << std::endl;
+ShapeHandle Renderer::draw_line(int x1, int y1, int x2, int y2, int id) {
+    ShapeHandle handle = store_.add(ShapeKind::LINE, x1, y1, x2 - x1, y2 - y1, false, store_.intern_color(draw_color_), id);
+    damage_row(store_.row(handle));
+    touch();
+    ENGINE_LOG_TRACE("Drew line from ({},{}) to ({},{}) with id {}", x1, y1, x2, y2, id);
+    return handle;
 }
 
-void Renderer::draw_rect(int x, int y, int width, int height, bool filled, int id) {
-    shapes_.push_back(Rectangle{x, y, width, height, draw_color_, filled, id});
-    XSetForeground(dpy_, gc_, draw_color_.x11_color);
-    if (filled) {
-        XFillRectangle(dpy_, buffer_, gc_, x, y, width, height);
-    } else {
-        XDrawRectangle(dpy_, buffer_, gc_, x, y, width, height);
+ShapeHandle Renderer::draw_rect(int x, int y, int width, int height, bool filled, int id) {
+    ShapeHandle handle = store_.add(ShapeKind::RECT, x, y, width, height, filled, store_.intern_color(draw_color_), id);
+    damage_row(store_.row(handle));
+    touch();
+    ENGINE_LOG_TRACE("Drew rectangle at ({},{}) size ({},{}) with id {}", x, y, width, height, id);
+    return handle;
+}
+
+void Renderer::damage_row(uint32_t row) {
+    if (store_.columns().flags[row] & ShapeStore::VISIBLE) {
+        damage_.add(store_.bounds(row));
     }
-    std::cout << "Drew rectangle at (" << x << "," << y << ") size (" << width << "," << height << ") with id " << id << std::endl;
+}
+
+void Renderer::touch() {
+    dirty_ = true;
+    generation_++;
+}
+
+void Renderer::invalidate() {
+    damage_.add_all();
+    generation_++;
+}
+
+void Renderer::invalidate(int x, int y, int width, int height) {
+    damage_.add(Bounds{x, y, x + width, y + height});
+    generation_++;
 }
 
 void Renderer::remove_shape_by_id(int id) {
-    shapes_.erase(std::remove_if(shapes_.begin(), shapes_.end(),
-        [id](const Shape& shape) {
-            return std::visit([id](const auto& s) { return s.id == id; }, shape);
-        }), shapes_.end());
-    std::cout << "Removed shape with id " << id << std::endl;
-}
-
-void Renderer::present() {
-    std::cout << "Rendering " << shapes_.size() << " shapes" << std::endl;
-    XSetForeground(dpy_, gc_, draw_color_.x11_color);
-    XFillRectangle(dpy_, buffer_, gc_, 0, 0, width_, height_);
-    for (const auto& shape : shapes_) {
-        std::visit([&](const auto& s) {
-            XSetForeground(dpy_, gc_, s.color.x11_color);
-            if constexpr (std::is_same_v<std::decay_t<decltype(s)>, Point>) {
-                XDrawPoint(dpy_, buffer_, gc_, s.x, s.y);
-            } else if constexpr (std::is_same_v<std::decay_t<decltype(s)>, Line>) {
-                XDrawLine(dpy_, buffer_, gc_, s.x1, s.y1, s.x2, s.y2);
-            } else if constexpr (std::is_same_v<std::decay_t<decltype(s)>, Rectangle>) {
-                if (s.filled) {
-                    XFillRectangle(dpy_, buffer_, gc_, s.x, s.y, s.width, s.height);
-                } else {
-                    XDrawRectangle(dpy_, buffer_, gc_, s.x, s.y, s.width, s.height);
-                }
+    store_.for_each_with_id(id, [this](uint32_t row) { damage_row(row); });
+    if (store_.remove_by_id(id)) {
+        touch();
+    }
+    ENGINE_LOG_TRACE("Removed shape with id {}", id);
+}
+
+bool Renderer::remove_shape(ShapeHandle handle) {
+    uint32_t row = store_.row(handle);
+    if (row == SlotMap::NONE) {
+        return false;
+    }
+    damage_row(row);
+    store_.remove(handle);
+    touch();
+    return true;
+}
+
+template <typename F>
+bool Renderer::update_shape(ShapeHandle handle, F&& update) {
+    uint32_t row = store_.row(handle);
+    if (row == SlotMap::NONE) {
+        return false;
+    }
+    Bounds before = store_.bounds(row);
+    bool was_visible = store_.columns().flags[row] & ShapeStore::VISIBLE;
+    Edit edit = update(row);
+    if (edit != Edit::CHANGED) {
+        return edit == Edit::UNCHANGED;
+    }
+    if (was_visible) {
+        damage_.add(before);
+    }
+    damage_row(row);
+    touch();
+    return true;
+}
+
+template <typename F>
+void Renderer::update_shapes_by_id(int id, F&& update) {
+    store_.for_each_with_id(id, [&](uint32_t row) {
+        Bounds before = store_.bounds(row);
+        bool was_visible = store_.columns().flags[row] & ShapeStore::VISIBLE;
+        if (update(row) == Edit::CHANGED) {
+            if (was_visible) {
+                damage_.add(before);
             }
-        }, shape);
+            damage_row(row);
+            touch();
+        }
+    });
+}
+
+namespace {
+
+    // Edits that leave a shape as it was report UNCHANGED, so redundant
+    // updates (e.g. re-moving a shape to where it is every frame) neither
+    // damage anything nor wake the renderer from idle.
+    struct MoveTo {
+        ShapeColumns& c;
+        int x, y;
+        Edit operator()(uint32_t row) const {
+            if (c.x[row] == x && c.y[row] == y) {
+                return Edit::UNCHANGED;
+            }
+            c.x[row] = x;
+            c.y[row] = y;
+            return Edit::CHANGED;
+        }
+    };
+
+    struct ResizeTo {
+        ShapeColumns& c;
+        int width, height;
+        Edit operator()(uint32_t row) const {
+            if (c.kind[row] == ShapeKind::POINT) {
+                return Edit::REJECTED;
+            }
+            if (c.w[row] == width && c.h[row] == height) {
+                return Edit::UNCHANGED;
+            }
+            c.w[row] = width;
+            c.h[row] = height;
+            return Edit::CHANGED;
+        }
+    };
+
+    struct Recolor {
+        ShapeColumns& c;
+        uint16_t color;
+        Edit operator()(uint32_t row) const {
+            if (c.color[row] == color) {
+                return Edit::UNCHANGED;
+            }
+            c.color[row] = color;
+            return Edit::CHANGED;
+        }
+    };
+
+    struct SetVisible {
+        ShapeColumns& c;
+        bool visible;
+        Edit operator()(uint32_t row) const {
+            if (((c.flags[row] & ShapeStore::VISIBLE) != 0) == visible) {
+                return Edit::UNCHANGED;
+            }
+            if (visible) {
+                c.flags[row] |= ShapeStore::VISIBLE;
+            } else {
+                c.flags[row] &= static_cast<uint8_t>(~ShapeStore::VISIBLE);
+            }
+            return Edit::CHANGED;
+        }
+    };
+
+} // namespace
+
+bool Renderer::move_shape(ShapeHandle handle, int x, int y) {
+    return update_shape(handle, MoveTo{store_.columns(), x, y});
+}
+
+bool Renderer::resize_shape(ShapeHandle handle, int width, int height) {
+    return update_shape(handle, ResizeTo{store_.columns(), width, height});
+}
+
+bool Renderer::set_shape_color(ShapeHandle handle, unsigned char r, unsigned char g, unsigned char b, unsigned char a) {
+    if (!store_.contains(handle)) {
+        return false;
+    }
+    uint16_t color = store_.intern_color(Color{r, g, b, a, colors_.resolve(r, g, b)});
+    return update_shape(handle, Recolor{store_.columns(), color});
+}
+
+bool Renderer::set_shape_visible(ShapeHandle handle, bool visible) {
+    return update_shape(handle, SetVisible{store_.columns(), visible});
+}
+
+void Renderer::move_shape_by_id(int id, int x, int y) {
+    update_shapes_by_id(id, MoveTo{store_.columns(), x, y});
+}
+
+void Renderer::resize_shape_by_id(int id, int width, int height) {
+    update_shapes_by_id(id, ResizeTo{store_.columns(), width, height});
+}
+
+void Renderer::set_shape_color_by_id(int id, unsigned char r, unsigned char g, unsigned char b, unsigned char a) {
+    if (!store_.has_id(id)) {
+        return;
+    }
+    uint16_t color = store_.intern_color(Color{r, g, b, a, colors_.resolve(r, g, b)});
+    update_shapes_by_id(id, Recolor{store_.columns(), color});
+}
+
+void Renderer::set_shape_visible_by_id(int id, bool visible) {
+    update_shapes_by_id(id, SetVisible{store_.columns(), visible});
+}
+
+bool Renderer::present() {
+    ENGINE_PROFILE_ZONE("Renderer::present");
+    // The background follows the draw color, as clear() does
+    if (draw_color_.x11_color != background_pixel_) {
+        background_pixel_ = draw_color_.x11_color;
+        damage_.add_all();
+        generation_++;
+    }
+    if (!backbuffer_ready_ && !create_backbuffer()) {
+        // Not shown yet: nothing could be seen anyway
+        idle_ = true;
+        frame_stats_.skip_frame();
+        x_traffic_skip_frame();
+        return false;
+    }
+    fit_backbuffer();
+    if (generation_ == presented_generation_) {
+        // Nothing changed and nothing was exposed: no repaint, no copy,
+        // no X traffic, and the gap does not count as a slow frame
+        idle_ = true;
+        frame_stats_.skip_frame();
+        x_traffic_skip_frame();
+        return false;
+    }
+    idle_ = false;
+    presented_generation_ = generation_;
+    repaint_damage();
+    frame_stats_.end_frame();
+    x_traffic_end_frame();
+    if (!first_frame_ns_) {
+        first_frame_ns_ = monotonic_ns();
+        StartupReport report = startup();
+        ENGINE_LOG_INFO("First frame {} ms after window creation ({} ms until mapped), "
+                        "{} ms after process start",
+                        report.first_frame_ms, report.configure_ms, report.total_ms);
+    }
+    return true;
+}
+
+void Renderer::flush() {
+    if (confirm_present_) {
+        ENGINE_X_CALL(dpy_, "Renderer::flush XSync");
+        XSync(dpy_, False);
+    } else {
+        ENGINE_X_CALL(dpy_, "Renderer::flush XFlush");
+        XFlush(dpy_);
+    }
+}
+
+void Renderer::repaint_damage() {
+    if (damage_.empty()) {
+        dirty_ = false;
+        return;
+    }
+
+    repaint_.clear();
+    if (damage_.full()) {
+        repaint_.push_back(Bounds{0, 0, width_, height_});
+    } else {
+        for (const Bounds& rect : damage_.rects()) {
+            Bounds clipped = rect.clipped(width_, height_);
+            if (!clipped.empty()) {
+                repaint_.push_back(clipped);
+            }
+        }
+    }
+    damage_.clear();
+    dirty_ = false;
+    if (repaint_.empty()) {
+        return;
+    }
+
+    if (mode_ == RenderMode::SOFTWARE) {
+        present_software();
+    } else {
+        present_xlib();
+    }
+}
+
+void Renderer::present_xlib() {
+    PhaseLaps laps(frame_stats_);
+    clip_rects_.clear();
+    Bounds extent = repaint_.front();
+    for (const Bounds& rect : repaint_) {
+        extent.merge(rect);
+        clip_rects_.push_back(XRectangle{static_cast<short>(rect.x0), static_cast<short>(rect.y0),
+                                         static_cast<unsigned short>(rect.x1 - rect.x0),
+                                         static_cast<unsigned short>(rect.y1 - rect.y0)});
+    }
+
+    const ShapeColumns& c = store_.columns();
+    const std::vector<Color>& palette = store_.palette();
+    const size_t rows = store_.rows();
+    const bool single = repaint_.size() == 1;
+
+    {
+        ENGINE_PROFILE_ZONE("batch shapes");
+        batcher_.begin();
+        for (const Bounds& rect : repaint_) {
+            batcher_.add_rect(rect.x0, rect.y0, rect.x1 - rect.x0, rect.y1 - rect.y0, true, background_pixel_);
+        }
+        for (size_t i = 0; i < rows; ++i) {
+            if (!(c.flags[i] & ShapeStore::VISIBLE)) {
+                continue;
+            }
+            Bounds bounds = store_.bounds(static_cast<uint32_t>(i));
+            if (!bounds.intersects(extent)) {
+                continue;
+            }
+            if (!single && std::none_of(repaint_.begin(), repaint_.end(),
+                                        [&](const Bounds& rect) { return rect.intersects(bounds); })) {
+                continue;
+            }
+            unsigned long pixel = palette[c.color[i]].x11_color;
+            switch (c.kind[i]) {
+            case ShapeKind::POINT:
+                batcher_.add_point(c.x[i], c.y[i], pixel);
+                break;
+            case ShapeKind::LINE:
+                batcher_.add_line(c.x[i], c.y[i], c.x[i] + c.w[i], c.y[i] + c.h[i], pixel);
+                break;
+            case ShapeKind::RECT:
+                batcher_.add_rect(c.x[i], c.y[i], c.w[i], c.h[i], (c.flags[i] & ShapeStore::FILLED) != 0, pixel);
+                break;
+            }
+        }
+    }
+    laps.lap(FramePhase::BUILD);
+
+    size_t requests;
+    {
+        ENGINE_PROFILE_ZONE("submit");
+        {
+            ENGINE_X_CALL(dpy_, "Renderer::present XSetClipRectangles");
+            XSetClipRectangles(dpy_, gc_, 0, 0, clip_rects_.data(), static_cast<int>(clip_rects_.size()), Unsorted);
+        }
+        requests = batcher_.submit(dpy_, buffer_, gc_);
+        ENGINE_X_CALL(dpy_, "Renderer::present XSetClipMask");
+        XSetClipMask(dpy_, gc_, None);
+        XFlushGC(dpy_, gc_);
+    }
+    laps.lap(FramePhase::SUBMIT);
+
+    {
+        ENGINE_PROFILE_ZONE("copy and flush");
+        {
+            ENGINE_X_CALL(dpy_, "Renderer::present XCopyArea");
+            for (const XRectangle& rect : clip_rects_) {
+                XCopyArea(dpy_, buffer_, wd_, gc_, rect.x, rect.y, rect.width, rect.height, rect.x, rect.y);
+            }
+        }
+        flush();
+    }
+    laps.lap(FramePhase::FLUSH);
+    ENGINE_LOG_DEBUG("Rendering {} shapes in {} batches ({} requests) over {} damaged rects", store_.size(),
+                     batcher_.batch_count(), requests, clip_rects_.size());
+}
+
+void Renderer::present_software() {
+    PhaseLaps laps(frame_stats_);
+    Framebuffer fb{memory_.data(), width_, height_, buffer_width_};
+    if (surface_) {
+        // Waiting for the server to release a buffer counts as flush time
+        ENGINE_PROFILE_ZONE("acquire");
+        fb = surface_->acquire();
+        fb.width = width_;
+        fb.height = height_;
+    }
+    laps.lap(FramePhase::FLUSH);
+    // With double buffering the acquired buffer still holds the frame
+    // before last, so it also needs what was repainted last time (as far
+    // as it is still inside the window).
+    publish_ = repaint_;
+    if (surface_ && surface_->buffer_count() > 1) {
+        for (const Bounds& rect : previous_repaint_) {
+            Bounds clipped = rect.clipped(width_, height_);
+            if (!clipped.empty()) {
+                publish_.push_back(clipped);
+            }
+        }
+    }
+    tiles_.render(fb, store_, publish_, static_cast<uint32_t>(background_pixel_));
+    previous_repaint_ = repaint_;
+    laps.lap(FramePhase::BUILD);
+    if (xcb_surface_) {
+        {
+            ENGINE_PROFILE_ZONE("publish");
+            xcb_surface_->publish(fb, publish_);
+        }
+        laps.lap(FramePhase::SUBMIT);
+        {
+            ENGINE_PROFILE_ZONE("xcb_flush");
+            xcb_surface_->flush(confirm_present_);
+        }
+        laps.lap(FramePhase::FLUSH);
+        return;
+    }
+    if (!surface_) {
+        return;
+    }
+    {
+        ENGINE_PROFILE_ZONE("publish");
+        surface_->publish(wd_, gc_, publish_);
+    }
+    laps.lap(FramePhase::SUBMIT);
+    {
+        ENGINE_PROFILE_ZONE("XFlush");
+        flush();
     }
-    XSetForeground(dpy_, gc_, WhitePixel(dpy_, DefaultScreen(dpy_)));
-    XFillRectangle(dpy_, wd_, gc_, 100, 100, 200, 200); // Direct draw test
-    XCopyArea(dpy_, buffer_, wd_, gc_, 0, 0, width_, height_, 0, 0);
-    XFlush(dpy_);
+    laps.lap(FramePhase::FLUSH);
+    ENGINE_LOG_DEBUG("Rasterized {} shapes over {} damaged rects", store_.size(), publish_.size());
 }
 
 } // namespace platform
\ No newline at end of file
@@ -2,60 +2,180 @@
 #define PLATFORM_RENDERER_H
 
 #include "window.hpp"
+#include "color.hpp"
+#include "damage.hpp"
+#include "draw_batch.hpp"
+#include "frame_stats.hpp"
+#include "shape_store.hpp"
+#include "shm_surface.hpp"
+#include "xcb_surface.hpp"
+#include "tile_renderer.hpp"
+#include <cstdint>
+#include <memory>
 #include <vector>
-#include <variant>
 #include <functional>
 
 namespace platform {
 
-    struct Color {
-        unsigned char r, g, b, a;
-        unsigned long x11_color;
-        void allocate(Display* dpy, Colormap cmap);
+    // Time to first frame, in ms; -1 until reached.
+    struct StartupReport {
+        double process_ms;     // Process start to Window construction (10 ms resolution)
+        double configure_ms;   // Window construction to the first MapNotify / ConfigureNotify
+        double first_frame_ms; // Window construction to the first presented frame
+        double total_ms;       // Process start to the first presented frame
     };
 
-    struct Point {
-        int x, y;
-        Color color;
-        int id; // Unique identifier
-    };
-
-    struct Line {
-        int x1, y1, x2, y2;
-        Color color;
-        int id;
-    };
-
-    struct Rectangle {
-        int x, y, width, height;
-        Color color;
-        bool filled;
-        int id;
-    };
-
-    using Shape = std::variant<Point, Line, Rectangle>;
+    enum class RenderMode {
+        XLIB,     // Batched Xlib requests into a server-side pixmap
+        SOFTWARE  // CPU rasterizer into a client framebuffer, uploaded via MIT-SHM
+    };          // Headless and XCB windows always use SOFTWARE with an in-memory buffer
 
     class Renderer {
     public:
-        Renderer(const Window& window);
+        Renderer(const Window& window, RenderMode mode = RenderMode::XLIB);
         ~Renderer();
         void set_draw_color(unsigned char r, unsigned char g, unsigned char b, unsigned char a = 255);
         void clear();
-        void draw_point(int x, int y, int id = 0);
-        void draw_line(int x1, int y1, int x2, int y2, int id = 0);
-        void draw_rect(int x, int y, int width, int height, bool filled = false, int id = 0);
+        // Shapes drawn with id 0 are anonymous: they are only reachable
+        // through the returned handle and are ignored by remove_shape_by_id.
+        ShapeHandle draw_point(int x, int y, int id = 0);
+        ShapeHandle draw_line(int x1, int y1, int x2, int y2, int id = 0);
+        ShapeHandle draw_rect(int x, int y, int width, int height, bool filled = false, int id = 0);
         void remove_shape_by_id(int id);
-        void present();
+        bool remove_shape(ShapeHandle handle);
+        bool contains(ShapeHandle handle) const { return store_.contains(handle); }
+        size_t shape_count() const { return store_.size(); }
+
+        // Retained-mode updates. These only touch the stored record; the
+        // change becomes visible on the next present(). Moving a line
+        // translates it so that (x1, y1) lands on (x, y); resizing a line
+        // sets its extent relative to (x1, y1). Points cannot be resized.
+        bool move_shape(ShapeHandle handle, int x, int y);
+        bool resize_shape(ShapeHandle handle, int width, int height);
+        bool set_shape_color(ShapeHandle handle, unsigned char r, unsigned char g, unsigned char b, unsigned char a = 255);
+        bool set_shape_visible(ShapeHandle handle, bool visible);
+        void move_shape_by_id(int id, int x, int y);
+        void resize_shape_by_id(int id, int width, int height);
+        void set_shape_color_by_id(int id, unsigned char r, unsigned char g, unsigned char b, unsigned char a = 255);
+        void set_shape_visible_by_id(int id, bool visible);
+
+        // True when shapes were added, removed or updated since the last present().
+        bool dirty() const { return dirty_; }
+        // Forces an area (or everything) to be repainted on the next
+        // present(), e.g. after an Expose.
+        void invalidate();
+        void invalidate(int x, int y, int width, int height);
+        // Repaints only the damaged areas of the back buffer and copies just
+        // those to the window. Returns false without doing anything when
+        // the scene is unchanged since the last present and nothing was
+        // exposed or invalidated.
+        //
+        // X11 windows get their back buffer (pixmap or MIT-SHM images) on
+        // the first present after Window::show(), at the size the first
+        // MapNotify / ConfigureNotify reports, so startup does not wait on
+        // the server before there is a frame to show. If neither has
+        // arrived yet, that present waits for it; before show() present()
+        // returns false.
+        //
+        // After a resize() the back buffer is kept while the window fits in
+        // it, and only the uncovered strips are repainted. It is
+        // reallocated, and the frame repainted in full, when the window
+        // outgrows it (with a quarter of headroom, up to the screen size)
+        // or shrinks below a quarter of its area, so a live resize
+        // reallocates every few dozen pixels rather than on every event.
+        bool present();
+        // Bumped by every change to the scene and by invalidate()
+        uint64_t scene_generation() const { return generation_; }
+        // True when the last present() found nothing to do; a main loop can
+        // then block on input instead of waking for frames.
+        bool idle() const { return idle_; }
+        // Phase timings and frame-time histogram. present() ends a frame,
+        // here and in the X request accounting (x_traffic.hpp);
+        // ENGINE_FRAME_STATS=<path> enables a periodic dump at startup.
+        FrameStats& frame_stats() { return frame_stats_; }
+        const FrameStats& frame_stats() const { return frame_stats_; }
+        // Logged at INFO when the first frame is presented
+        StartupReport startup() const;
+        // Follows the window's size; Event calls this for each
+        // ConfigureNotify. Rendering and copies are clipped to it, and the
+        // back buffer is fitted on the next present().
+        void resize(int width, int height);
+        // Lets the renderer see the window's events: MIT-SHM completions
+        // are consumed (returns true); MapNotify / ConfigureNotify are
+        // noted and passed on (returns false).
+        bool handle_event(const XEvent& event);
+        RenderMode mode() const { return mode_; }
+        // Threads used by the SOFTWARE rasterizer, including the calling
+        // thread. Defaults to ENGINE_RENDER_THREADS, or 1 when unset.
+        void set_thread_count(size_t threads) { tiles_.set_thread_count(threads); }
+        size_t thread_count() const { return tiles_.thread_count(); }
+        // Ends each present with an XSync instead of an XFlush, so the
+        // frame time and input latency include the server executing the
+        // copy. Costs a round trip per frame. Defaults to
+        // ENGINE_CONFIRM_PRESENT=1.
+        void set_confirm_present(bool confirm) { confirm_present_ = confirm; }
+        bool confirm_present() const { return confirm_present_; }
+
+        // Pixel values of the last presented frame, row-major. Headless
+        // renderers use 0x00RRGGBB. The XLIB mode reads the back buffer
+        // with XGetImage, which is a round trip.
+        std::vector<uint32_t> read_pixels() const;
+        uint32_t read_pixel(int x, int y) const;
+        // Current window size
+        int width() const { return width_; }
+        int height() const { return height_; }
+        // Allocated back buffer size, 0 until it exists
+        int buffer_width() const { return buffer_width_; }
+        int buffer_height() const { return buffer_height_; }
 
     private:
+        const Window& window_;
+        RenderMode mode_;
         Display* dpy_;
         ::Window wd_;
         Pixmap buffer_;
         int width_, height_;
-        Colormap cmap_;
+        int buffer_width_, buffer_height_;
         GC gc_;
+        ColorResolver colors_;
         Color draw_color_;
-        std::vector<Shape> shapes_;
+        unsigned long background_pixel_;
+        ShapeStore store_;
+        DrawBatcher batcher_;
+        DamageRegion damage_;
+        std::vector<Bounds> repaint_;
+        std::vector<XRectangle> clip_rects_;
+        std::unique_ptr<ShmSurface> surface_;
+        std::unique_ptr<XcbSurface> xcb_surface_; // XCB backend
+        std::vector<uint32_t> memory_; // Headless / XCB framebuffer
+        std::vector<Bounds> publish_;
+        std::vector<Bounds> previous_repaint_;
+        TileRenderer tiles_;
+        FrameStats frame_stats_;
+        bool confirm_present_;
+        bool backbuffer_ready_;
+        bool configured_;     // A MapNotify / ConfigureNotify gave the size
+        uint64_t configured_ns_;
+        uint64_t first_frame_ns_;
+        bool dirty_;
+        uint64_t generation_;
+        uint64_t presented_generation_;
+        bool idle_;
+
+        bool create_backbuffer();
+        void fit_backbuffer();
+        void allocate_backbuffer(int width, int height);
+        void damage_row(uint32_t row);
+        void touch();
+        void flush();
+        void repaint_damage();
+        void present_xlib();
+        void present_software();
+
+        template <typename F>
+        bool update_shape(ShapeHandle handle, F&& update);
+        template <typename F>
+        void update_shapes_by_id(int id, F&& update);
     };
 
 } // namespace platform
@@ -0,0 +1,64 @@
+#ifndef PLATFORM_RING_BUFFER_HPP
+#define PLATFORM_RING_BUFFER_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace platform {
+
+    // Fixed-capacity FIFO stored inline, so pushing never allocates.
+    // Capacity must be a power of two. When full, push() refuses the new
+    // element and counts it in overflowed() rather than growing.
+    template <typename T, size_t N>
+    class RingBuffer {
+        static_assert(N > 0 && (N & (N - 1)) == 0, "RingBuffer capacity must be a power of two");
+
+    public:
+        bool push(const T& value) {
+            if (full()) {
+                overflowed_++;
+                return false;
+            }
+            items_[(head_ + size_) & (N - 1)] = value;
+            size_++;
+            return true;
+        }
+
+        bool pop(T& value) {
+            if (empty()) {
+                return false;
+            }
+            value = items_[head_];
+            head_ = (head_ + 1) & (N - 1);
+            size_--;
+            return true;
+        }
+
+        // Oldest element first
+        const T& operator[](size_t i) const { return items_[(head_ + i) & (N - 1)]; }
+        T& operator[](size_t i) { return items_[(head_ + i) & (N - 1)]; }
+        T& back() { return (*this)[size_ - 1]; }
+
+        size_t size() const { return size_; }
+        bool empty() const { return size_ == 0; }
+        bool full() const { return size_ == N; }
+        static constexpr size_t capacity() { return N; }
+        // Pushes refused because the buffer was full, since construction
+        uint64_t overflowed() const { return overflowed_; }
+
+        void clear() {
+            head_ = 0;
+            size_ = 0;
+        }
+
+    private:
+        std::array<T, N> items_{};
+        size_t head_ = 0;
+        size_t size_ = 0;
+        uint64_t overflowed_ = 0;
+    };
+
+} // namespace platform
+
+#endif // PLATFORM_RING_BUFFER_HPP
\ No newline at end of file
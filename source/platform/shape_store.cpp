@@ -0,0 +1,141 @@
+#include "shape_store.hpp"
+#include <stdexcept>
+
+namespace platform {
+
+ShapeHandle ShapeStore::add(ShapeKind kind, int x, int y, int w, int h, bool filled, uint16_t color, int id) {
+    ShapeHandle handle = slots_.insert();
+    columns_.kind.push_back(kind);
+    columns_.flags.push_back(static_cast<uint8_t>(VISIBLE | (filled ? FILLED : 0)));
+    columns_.color.push_back(color);
+    columns_.x.push_back(x);
+    columns_.y.push_back(y);
+    columns_.w.push_back(w);
+    columns_.h.push_back(h);
+    columns_.id.push_back(id);
+    if (id != 0) {
+        ids_.emplace(id, handle);
+    }
+    return handle;
+}
+
+void ShapeStore::unlink_id(int id, ShapeHandle handle) {
+    auto range = ids_.equal_range(id);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (it->second == handle) {
+            ids_.erase(it);
+            return;
+        }
+    }
+}
+
+void ShapeStore::release_row(uint32_t row) {
+    columns_.flags[row] = 0;
+    if (!slots_.needs_compaction()) {
+        return;
+    }
+    ShapeColumns& c = columns_;
+    size_t rows = slots_.compact([&c](size_t from, size_t to) {
+        c.kind[to] = c.kind[from];
+        c.flags[to] = c.flags[from];
+        c.color[to] = c.color[from];
+        c.x[to] = c.x[from];
+        c.y[to] = c.y[from];
+        c.w[to] = c.w[from];
+        c.h[to] = c.h[from];
+        c.id[to] = c.id[from];
+    });
+    c.kind.resize(rows);
+    c.flags.resize(rows);
+    c.color.resize(rows);
+    c.x.resize(rows);
+    c.y.resize(rows);
+    c.w.resize(rows);
+    c.h.resize(rows);
+    c.id.resize(rows);
+}
+
+bool ShapeStore::remove(ShapeHandle handle) {
+    uint32_t row = slots_.erase(handle);
+    if (row == SlotMap::NONE) {
+        return false;
+    }
+    if (columns_.id[row] != 0) {
+        unlink_id(columns_.id[row], handle);
+    }
+    release_row(row);
+    return true;
+}
+
+bool ShapeStore::remove_by_id(int id) {
+    auto range = ids_.equal_range(id);
+    if (range.first == range.second) {
+        return false;
+    }
+    for (auto it = range.first; it != range.second; ++it) {
+        uint32_t row = slots_.erase(it->second);
+        if (row != SlotMap::NONE) {
+            release_row(row);
+        }
+    }
+    ids_.erase(range.first, range.second);
+    return true;
+}
+
+void ShapeStore::clear() {
+    slots_.clear();
+    ids_.clear();
+    columns_.kind.clear();
+    columns_.flags.clear();
+    columns_.color.clear();
+    columns_.x.clear();
+    columns_.y.clear();
+    columns_.w.clear();
+    columns_.h.clear();
+    columns_.id.clear();
+}
+
+uint16_t ShapeStore::intern_color(const Color& color) {
+    uint32_t key = color_key(color);
+    auto it = palette_index_.find(key);
+    if (it != palette_index_.end()) {
+        return it->second;
+    }
+    if (palette_.size() == MAX_PALETTE) {
+        compact_palette();
+        if (palette_.size() == MAX_PALETTE) {
+            throw std::runtime_error("ERROR: Shape color palette exhausted");
+        }
+    }
+    uint16_t index = static_cast<uint16_t>(palette_.size());
+    palette_.push_back(color);
+    palette_index_.emplace(key, index);
+    return index;
+}
+
+// Drops palette entries no live shape refers to and renumbers the rest.
+// Any index the caller still holds outside the store is invalidated.
+void ShapeStore::compact_palette() {
+    std::vector<uint16_t> remap(palette_.size(), 0);
+    std::vector<bool> used(palette_.size(), false);
+    for (size_t i = 0; i < columns_.color.size(); ++i) {
+        if (slots_.alive(i)) {
+            used[columns_.color[i]] = true;
+        }
+    }
+    std::vector<Color> palette;
+    palette_index_.clear();
+    for (size_t i = 0; i < palette_.size(); ++i) {
+        if (used[i]) {
+            remap[i] = static_cast<uint16_t>(palette.size());
+            palette_index_.emplace(color_key(palette_[i]), remap[i]);
+            palette.push_back(palette_[i]);
+        }
+    }
+    for (size_t i = 0; i < columns_.color.size(); ++i) {
+        columns_.color[i] = remap[columns_.color[i]];
+    }
+    palette_.swap(palette);
+}
+
+} // namespace platform
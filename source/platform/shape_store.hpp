@@ -0,0 +1,100 @@
+#ifndef PLATFORM_SHAPE_STORE_HPP
+#define PLATFORM_SHAPE_STORE_HPP
+
+#include "color.hpp"
+#include "geometry.hpp"
+#include "slot_map.hpp"
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace platform {
+
+    enum class ShapeKind : uint8_t {
+        POINT,
+        LINE,
+        RECT
+    };
+
+    // One row per retained shape, in draw order. Geometry is uniform across
+    // kinds: (x, y) is the point, the line start or the rectangle origin, and
+    // (w, h) is the line's delta to its end point or the rectangle size.
+    struct ShapeColumns {
+        std::vector<ShapeKind> kind;
+        std::vector<uint8_t> flags;
+        std::vector<uint16_t> color; // Index into ShapeStore::palette()
+        std::vector<int32_t> x, y, w, h;
+        std::vector<int32_t> id;
+    };
+
+    // Structure-of-arrays shape storage. Removed rows keep their place with
+    // flags cleared until the slot map asks for compaction, so hot loops only
+    // need to test VISIBLE.
+    class ShapeStore {
+    public:
+        static constexpr uint8_t FILLED = 1;
+        static constexpr uint8_t VISIBLE = 2;
+
+        ShapeHandle add(ShapeKind kind, int x, int y, int w, int h, bool filled, uint16_t color, int id);
+        bool remove(ShapeHandle handle);
+        bool remove_by_id(int id);
+        void clear();
+
+        // Dense row for a handle, or SlotMap::NONE if it is stale.
+        uint32_t row(ShapeHandle handle) const { return slots_.dense_index(handle); }
+        bool contains(ShapeHandle handle) const { return slots_.contains(handle); }
+
+        template <typename F>
+        void for_each_with_id(int id, F&& f) {
+            auto range = ids_.equal_range(id);
+            for (auto it = range.first; it != range.second; ++it) {
+                uint32_t r = slots_.dense_index(it->second);
+                if (r != SlotMap::NONE) {
+                    f(r);
+                }
+            }
+        }
+        bool has_id(int id) const { return ids_.find(id) != ids_.end(); }
+
+        // Pixels a row can touch when drawn, including the extra right and
+        // bottom pixel of outlined rectangles.
+        Bounds bounds(uint32_t row) const {
+            int x = columns_.x[row], y = columns_.y[row];
+            int w = columns_.w[row], h = columns_.h[row];
+            if (columns_.kind[row] == ShapeKind::RECT && (columns_.flags[row] & FILLED)) {
+                return Bounds{x, y, x + w, y + h};
+            }
+            return Bounds{std::min(x, x + w), std::min(y, y + h), std::max(x, x + w) + 1, std::max(y, y + h) + 1};
+        }
+
+        size_t size() const { return slots_.size(); }
+        size_t rows() const { return slots_.dense_size(); }
+        const ShapeColumns& columns() const { return columns_; }
+        ShapeColumns& columns() { return columns_; }
+
+        // Palette entries are shared by every shape with the same RGBA value.
+        uint16_t intern_color(const Color& color);
+        const std::vector<Color>& palette() const { return palette_; }
+
+    private:
+        static constexpr size_t MAX_PALETTE = 0x10000;
+
+        static uint32_t color_key(const Color& color) {
+            return (static_cast<uint32_t>(color.r) << 24) | (static_cast<uint32_t>(color.g) << 16) |
+                   (static_cast<uint32_t>(color.b) << 8) | color.a;
+        }
+
+        void unlink_id(int id, ShapeHandle handle);
+        void release_row(uint32_t row);
+        void compact_palette();
+
+        SlotMap slots_;
+        ShapeColumns columns_;
+        std::unordered_multimap<int, ShapeHandle> ids_;
+        std::vector<Color> palette_;
+        std::unordered_map<uint32_t, uint16_t> palette_index_;
+    };
+
+} // namespace platform
+
+#endif // PLATFORM_SHAPE_STORE_HPP
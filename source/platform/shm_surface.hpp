@@ -0,0 +1,64 @@
+#ifndef PLATFORM_SHM_SURFACE_HPP
+#define PLATFORM_SHM_SURFACE_HPP
+
+#include "window.hpp"
+#include "framebuffer.hpp"
+#include "geometry.hpp"
+#include <X11/Xutil.h>
+#include <X11/extensions/XShm.h>
+#include <vector>
+
+namespace platform {
+
+    // Client-side framebuffer published to a window with XShmPutImage.
+    // Two MIT-SHM segments are used in turn; a segment is only handed back
+    // for drawing once the server has sent the ShmCompletion for its last
+    // upload, so the CPU can render frame N+1 while the server reads frame
+    // N. Without the extension (e.g. on a remote display) a single
+    // malloc'd XImage is uploaded with XPutImage instead.
+    class ShmSurface {
+    public:
+        ShmSurface(Display* dpy, int width, int height);
+        ~ShmSurface();
+        ShmSurface(const ShmSurface&) = delete;
+        ShmSurface& operator=(const ShmSurface&) = delete;
+
+        // Framebuffer for the next frame; blocks until the server is done with it.
+        Framebuffer acquire();
+        // The most recently published framebuffer, for read-back.
+        Framebuffer front() const;
+        // Uploads the given areas of the acquired framebuffer to target.
+        void publish(Drawable target, GC gc, const std::vector<Bounds>& rects);
+        // Consumes ShmCompletion events; returns false for anything else.
+        bool handle_event(const XEvent& event);
+
+        bool uses_shm() const { return shm_; }
+        // Frames a buffer's content lags behind when handed out again.
+        size_t buffer_count() const { return buffers_.size(); }
+        int width() const { return width_; }
+        int height() const { return height_; }
+
+    private:
+        struct Buffer {
+            XImage* image = nullptr;
+            XShmSegmentInfo segment{};
+            bool busy = false;
+        };
+
+        bool create_shm_buffers();
+        void create_plain_buffer();
+        void destroy_buffers();
+        void wait_for(Buffer& buffer);
+        Framebuffer framebuffer(const Buffer& buffer) const;
+
+        Display* dpy_;
+        int width_, height_;
+        bool shm_;
+        int completion_type_;
+        std::vector<Buffer> buffers_;
+        size_t current_;
+    };
+
+} // namespace platform
+
+#endif // PLATFORM_SHM_SURFACE_HPP
@@ -0,0 +1,196 @@
+#include "shm_surface.hpp"
+#include "log.hpp"
+#include "x_traffic.hpp"
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace platform {
+
+namespace {
+
+    bool attach_failed = false;
+
+    int record_attach_error(Display*, XErrorEvent*) {
+        attach_failed = true;
+        return 0;
+    }
+
+    // XShmAttach fails asynchronously (BadAccess when the server cannot see
+    // our segment), so sync with a temporary handler to find out.
+    bool checked_attach(Display* dpy, XShmSegmentInfo* segment) {
+        ENGINE_X_CALL(dpy, "ShmSurface XShmAttach");
+        XSync(dpy, False);
+        attach_failed = false;
+        auto previous = XSetErrorHandler(record_attach_error);
+        bool ok = XShmAttach(dpy, segment);
+        XSync(dpy, False);
+        XSetErrorHandler(previous);
+        return ok && !attach_failed;
+    }
+
+} // namespace
+
+ShmSurface::ShmSurface(Display* dpy, int width, int height)
+    : dpy_(dpy),
+      width_(width),
+      height_(height),
+      shm_(false),
+      completion_type_(-1),
+      current_(0) {
+    bool extension;
+    {
+        ENGINE_X_CALL(dpy_, "ShmSurface::ShmSurface XShmQueryExtension");
+        extension = XShmQueryExtension(dpy_);
+    }
+    if (extension && create_shm_buffers()) {
+        shm_ = true;
+        completion_type_ = XShmGetEventBase(dpy_) + ShmCompletion;
+        ENGINE_LOG_INFO("Using MIT-SHM framebuffer ({} segments)", buffers_.size());
+    } else {
+        create_plain_buffer();
+        ENGINE_LOG_INFO("MIT-SHM unavailable, using XPutImage framebuffer");
+    }
+}
+
+ShmSurface::~ShmSurface() {
+    destroy_buffers();
+}
+
+bool ShmSurface::create_shm_buffers() {
+    int screen = DefaultScreen(dpy_);
+    for (int i = 0; i < 2; ++i) {
+        Buffer buffer;
+        buffer.image = XShmCreateImage(dpy_, DefaultVisual(dpy_, screen), DefaultDepth(dpy_, screen),
+                                       ZPixmap, nullptr, &buffer.segment, width_, height_);
+        if (!buffer.image || buffer.image->bits_per_pixel != 32) {
+            if (buffer.image) {
+                XDestroyImage(buffer.image);
+            }
+            destroy_buffers();
+            return false;
+        }
+        size_t size = static_cast<size_t>(buffer.image->bytes_per_line) * height_;
+        buffer.segment.shmid = shmget(IPC_PRIVATE, size, IPC_CREAT | 0600);
+        if (buffer.segment.shmid < 0) {
+            XDestroyImage(buffer.image);
+            destroy_buffers();
+            return false;
+        }
+        buffer.segment.shmaddr = buffer.image->data = static_cast<char*>(shmat(buffer.segment.shmid, nullptr, 0));
+        buffer.segment.readOnly = False;
+        bool attached = buffer.segment.shmaddr != reinterpret_cast<char*>(-1) && checked_attach(dpy_, &buffer.segment);
+        // Mark for removal now so the segment cannot leak if we crash
+        shmctl(buffer.segment.shmid, IPC_RMID, nullptr);
+        if (!attached) {
+            if (buffer.segment.shmaddr != reinterpret_cast<char*>(-1)) {
+                shmdt(buffer.segment.shmaddr);
+            }
+            buffer.image->data = nullptr;
+            XDestroyImage(buffer.image);
+            destroy_buffers();
+            return false;
+        }
+        buffers_.push_back(buffer);
+    }
+    return true;
+}
+
+void ShmSurface::create_plain_buffer() {
+    int screen = DefaultScreen(dpy_);
+    Buffer buffer;
+    buffer.image = XCreateImage(dpy_, DefaultVisual(dpy_, screen), DefaultDepth(dpy_, screen),
+                                ZPixmap, 0, nullptr, width_, height_, 32, 0);
+    if (!buffer.image || buffer.image->bits_per_pixel != 32) {
+        if (buffer.image) {
+            XDestroyImage(buffer.image);
+        }
+        throw std::runtime_error("ERROR: Software framebuffer needs a 32 bits per pixel visual");
+    }
+    buffer.image->data = static_cast<char*>(std::calloc(buffer.image->bytes_per_line, height_));
+    if (!buffer.image->data) {
+        XDestroyImage(buffer.image);
+        throw std::runtime_error("ERROR: Failed to allocate software framebuffer");
+    }
+    buffers_.push_back(buffer);
+}
+
+void ShmSurface::destroy_buffers() {
+    for (Buffer& buffer : buffers_) {
+        if (shm_ || buffer.segment.shmaddr) {
+            wait_for(buffer);
+            XShmDetach(dpy_, &buffer.segment);
+            XSync(dpy_, False);
+            shmdt(buffer.segment.shmaddr);
+            buffer.image->data = nullptr; // Not ours to free()
+        }
+        XDestroyImage(buffer.image);
+    }
+    buffers_.clear();
+}
+
+void ShmSurface::wait_for(Buffer& buffer) {
+    if (!buffer.busy) {
+        return;
+    }
+    ENGINE_X_CALL(dpy_, "ShmSurface::wait_for XIfEvent");
+    while (buffer.busy) {
+        XEvent event;
+        XIfEvent(dpy_, &event, [](Display*, XEvent* ev, XPointer arg) -> Bool {
+            return ev->type == reinterpret_cast<ShmSurface*>(arg)->completion_type_;
+        }, reinterpret_cast<XPointer>(this));
+        handle_event(event);
+    }
+}
+
+Framebuffer ShmSurface::acquire() {
+    wait_for(buffers_[current_]);
+    return framebuffer(buffers_[current_]);
+}
+
+Framebuffer ShmSurface::front() const {
+    return framebuffer(buffers_[(current_ + buffers_.size() - 1) % buffers_.size()]);
+}
+
+Framebuffer ShmSurface::framebuffer(const Buffer& buffer) const {
+    Framebuffer fb;
+    fb.pixels = reinterpret_cast<uint32_t*>(buffer.image->data);
+    fb.width = width_;
+    fb.height = height_;
+    fb.stride = buffer.image->bytes_per_line / 4;
+    return fb;
+}
+
+void ShmSurface::publish(Drawable target, GC gc, const std::vector<Bounds>& rects) {
+    Buffer& buffer = buffers_[current_];
+    ENGINE_X_CALL(dpy_, "ShmSurface::publish XShmPutImage");
+    for (size_t i = 0; i < rects.size(); ++i) {
+        const Bounds& r = rects[i];
+        unsigned int w = r.x1 - r.x0, h = r.y1 - r.y0;
+        if (shm_) {
+            // Only the last upload asks for a completion; requests are processed in order
+            bool last = i + 1 == rects.size();
+            XShmPutImage(dpy_, target, gc, buffer.image, r.x0, r.y0, r.x0, r.y0, w, h, last ? True : False);
+            buffer.busy = buffer.busy || last;
+        } else {
+            XPutImage(dpy_, target, gc, buffer.image, r.x0, r.y0, r.x0, r.y0, w, h);
+        }
+    }
+    current_ = (current_ + 1) % buffers_.size();
+}
+
+bool ShmSurface::handle_event(const XEvent& event) {
+    if (!shm_ || event.type != completion_type_) {
+        return false;
+    }
+    const auto& completion = reinterpret_cast<const XShmCompletionEvent&>(event);
+    for (Buffer& buffer : buffers_) {
+        if (buffer.segment.shmseg == completion.shmseg) {
+            buffer.busy = false;
+        }
+    }
+    return true;
+}
+
+} // namespace platform
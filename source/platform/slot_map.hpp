@@ -0,0 +1,141 @@
+#ifndef PLATFORM_SLOT_MAP_HPP
+#define PLATFORM_SLOT_MAP_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace platform {
+
+    // Stable reference to a retained shape. A handle stays valid until its
+    // shape is removed; the slot generation is bumped on removal so stale
+    // handles are rejected instead of aliasing a recycled slot.
+    struct ShapeHandle {
+        static constexpr uint32_t INVALID_INDEX = 0xffffffffu;
+
+        uint32_t index = INVALID_INDEX;
+        uint32_t generation = 0;
+
+        bool valid() const { return index != INVALID_INDEX; }
+        bool operator==(const ShapeHandle& other) const {
+            return index == other.index && generation == other.generation;
+        }
+        bool operator!=(const ShapeHandle& other) const { return !(*this == other); }
+    };
+
+    // Generational slot map with O(1) insert/erase/lookup. It only manages
+    // the mapping from handles to rows of dense, caller-owned storage (the
+    // shape columns), which stay in insertion order so painter's order is
+    // preserved. Erasing tombstones a row; once tombstones make up half of
+    // the rows the caller compacts its storage through compact(), which
+    // keeps erase amortized O(1).
+    class SlotMap {
+    public:
+        static constexpr uint32_t NONE = 0xffffffffu;
+
+        // Reserves the next dense row (dense_size() before the call).
+        ShapeHandle insert() {
+            uint32_t slot_index;
+            if (free_head_ != NONE) {
+                slot_index = free_head_;
+                free_head_ = slots_[slot_index].dense;
+            } else {
+                slot_index = static_cast<uint32_t>(slots_.size());
+                slots_.push_back(Slot{NONE, 0});
+            }
+            slots_[slot_index].dense = static_cast<uint32_t>(owners_.size());
+            owners_.push_back(slot_index);
+            return ShapeHandle{slot_index, slots_[slot_index].generation};
+        }
+
+        // Returns the tombstoned row, or NONE for a stale handle.
+        uint32_t erase(ShapeHandle handle) {
+            uint32_t row = dense_index(handle);
+            if (row == NONE) {
+                return NONE;
+            }
+            Slot& slot = slots_[handle.index];
+            owners_[row] = NONE;
+            slot.generation++;
+            slot.dense = free_head_;
+            free_head_ = handle.index;
+            tombstones_++;
+            return row;
+        }
+
+        uint32_t dense_index(ShapeHandle handle) const {
+            if (handle.index >= slots_.size() || slots_[handle.index].generation != handle.generation) {
+                return NONE;
+            }
+            uint32_t row = slots_[handle.index].dense;
+            return (row < owners_.size() && owners_[row] == handle.index) ? row : NONE;
+        }
+
+        bool contains(ShapeHandle handle) const { return dense_index(handle) != NONE; }
+        bool alive(size_t row) const { return owners_[row] != NONE; }
+
+        ShapeHandle handle_at(size_t row) const {
+            uint32_t slot_index = owners_[row];
+            return slot_index == NONE ? ShapeHandle{} : ShapeHandle{slot_index, slots_[slot_index].generation};
+        }
+
+        bool needs_compaction() const {
+            return tombstones_ >= MIN_COMPACT && tombstones_ * 2 >= owners_.size();
+        }
+
+        // Squeezes out tombstones, calling move(from, to) for every live row
+        // that shifts down. Returns the new number of rows.
+        template <typename F>
+        size_t compact(F&& move) {
+            size_t out = 0;
+            for (size_t i = 0; i < owners_.size(); ++i) {
+                if (owners_[i] == NONE) {
+                    continue;
+                }
+                if (out != i) {
+                    move(i, out);
+                    owners_[out] = owners_[i];
+                }
+                slots_[owners_[out]].dense = static_cast<uint32_t>(out);
+                out++;
+            }
+            owners_.resize(out);
+            tombstones_ = 0;
+            return out;
+        }
+
+        void clear() {
+            // Bump every live slot so outstanding handles go stale.
+            for (uint32_t owner : owners_) {
+                if (owner != NONE) {
+                    Slot& slot = slots_[owner];
+                    slot.generation++;
+                    slot.dense = free_head_;
+                    free_head_ = owner;
+                }
+            }
+            owners_.clear();
+            tombstones_ = 0;
+        }
+
+        size_t size() const { return owners_.size() - tombstones_; }
+        size_t dense_size() const { return owners_.size(); }
+        bool empty() const { return size() == 0; }
+
+    private:
+        static constexpr size_t MIN_COMPACT = 64;
+
+        struct Slot {
+            uint32_t dense;      // Dense row, or next free slot while unused
+            uint32_t generation;
+        };
+
+        std::vector<uint32_t> owners_; // Slot index per dense row, NONE for tombstones
+        std::vector<Slot> slots_;
+        uint32_t free_head_ = NONE;
+        size_t tombstones_ = 0;
+    };
+
+} // namespace platform
+
+#endif // PLATFORM_SLOT_MAP_HPP
@@ -0,0 +1,61 @@
+#ifndef PLATFORM_SPSC_QUEUE_HPP
+#define PLATFORM_SPSC_QUEUE_HPP
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+namespace platform {
+
+    // Bounded lock-free queue for exactly one producer thread and one
+    // consumer thread. Capacity must be a power of two. Each side keeps a
+    // cached copy of the other side's index, so the shared cache lines are
+    // only touched when the queue looks full (producer) or empty (consumer).
+    template <typename T, size_t N>
+    class SpscQueue {
+        static_assert(N > 0 && (N & (N - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+    public:
+        // Producer only. Returns false when full.
+        bool push(const T& value) {
+            size_t tail = tail_.load(std::memory_order_relaxed);
+            if (tail - head_cache_ == N) {
+                head_cache_ = head_.load(std::memory_order_acquire);
+                if (tail - head_cache_ == N) {
+                    return false;
+                }
+            }
+            items_[tail & (N - 1)] = value;
+            tail_.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer only. Returns false when empty.
+        bool pop(T& value) {
+            size_t head = head_.load(std::memory_order_relaxed);
+            if (head == tail_cache_) {
+                tail_cache_ = tail_.load(std::memory_order_acquire);
+                if (head == tail_cache_) {
+                    return false;
+                }
+            }
+            value = items_[head & (N - 1)];
+            head_.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        static constexpr size_t capacity() { return N; }
+
+    private:
+        // Consumer side
+        alignas(64) std::atomic<size_t> head_{0};
+        size_t tail_cache_ = 0;
+        // Producer side
+        alignas(64) std::atomic<size_t> tail_{0};
+        size_t head_cache_ = 0;
+        alignas(64) std::array<T, N> items_{};
+    };
+
+} // namespace platform
+
+#endif // PLATFORM_SPSC_QUEUE_HPP
\ No newline at end of file
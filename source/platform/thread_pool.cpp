@@ -0,0 +1,107 @@
+#include "thread_pool.hpp"
+#include "profiler.hpp"
+#include <algorithm>
+
+namespace platform {
+
+ThreadPool::ThreadPool(size_t threads) {
+    threads = std::max<size_t>(threads, 1);
+    for (size_t i = 0; i < threads; ++i) {
+        queues_.push_back(std::make_unique<Queue>());
+    }
+    // Queue 0 belongs to the thread calling run()
+    for (size_t i = 1; i < threads; ++i) {
+        threads_.emplace_back(&ThreadPool::worker_loop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (std::thread& thread : threads_) {
+        thread.join();
+    }
+}
+
+bool ThreadPool::pop(size_t self, size_t& item) {
+    {
+        Queue& own = *queues_[self];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.items.empty()) {
+            item = own.items.front();
+            own.items.pop_front();
+            return true;
+        }
+    }
+    for (size_t offset = 1; offset < queues_.size(); ++offset) {
+        Queue& victim = *queues_[(self + offset) % queues_.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.items.empty()) {
+            item = victim.items.back();
+            victim.items.pop_back();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::drain(size_t self) {
+    size_t item;
+    while (pop(self, item)) {
+        (*task_)(item);
+        if (remaining_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            std::lock_guard<std::mutex> lock(mutex_);
+            done_.notify_all();
+        }
+    }
+}
+
+void ThreadPool::worker_loop(size_t self) {
+    if (ENGINE_PROFILE) {
+        profiler_set_thread_name("worker " + std::to_string(self));
+    }
+    uint64_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+            if (stop_) {
+                return;
+            }
+            seen = generation_;
+        }
+        drain(self);
+    }
+}
+
+void ThreadPool::run(size_t count, const std::function<void(size_t)>& task) {
+    if (count == 0) {
+        return;
+    }
+    if (queues_.size() == 1) {
+        for (size_t i = 0; i < count; ++i) {
+            task(i);
+        }
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        task_ = &task;
+        remaining_.store(count, std::memory_order_relaxed);
+        for (size_t i = 0; i < count; ++i) {
+            Queue& queue = *queues_[i % queues_.size()];
+            std::lock_guard<std::mutex> queue_lock(queue.mutex);
+            queue.items.push_back(i);
+        }
+        generation_++;
+    }
+    wake_.notify_all();
+    drain(0);
+    std::unique_lock<std::mutex> lock(mutex_);
+    done_.wait(lock, [&] { return remaining_.load(std::memory_order_acquire) == 0; });
+}
+
+} // namespace platform
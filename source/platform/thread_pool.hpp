@@ -0,0 +1,56 @@
+#ifndef PLATFORM_THREAD_POOL_HPP
+#define PLATFORM_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace platform {
+
+    // Fork-join pool with per-thread work queues. run() deals task indices
+    // round-robin onto the queues; each thread pops from the front of its
+    // own queue and, once that is empty, steals from the back of the
+    // others, so uneven tasks (dense vs empty tiles) balance out. The
+    // calling thread works too, so a pool of size 1 runs inline.
+    class ThreadPool {
+    public:
+        explicit ThreadPool(size_t threads);
+        ~ThreadPool();
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool& operator=(const ThreadPool&) = delete;
+
+        // Runs task(i) for every i in [0, count); returns once all are done.
+        void run(size_t count, const std::function<void(size_t)>& task);
+        size_t size() const { return queues_.size(); }
+
+    private:
+        struct Queue {
+            std::mutex mutex;
+            std::deque<size_t> items;
+        };
+
+        bool pop(size_t self, size_t& item);
+        void drain(size_t self);
+        void worker_loop(size_t self);
+
+        std::vector<std::unique_ptr<Queue>> queues_;
+        std::vector<std::thread> threads_;
+        std::mutex mutex_;
+        std::condition_variable wake_;
+        std::condition_variable done_;
+        const std::function<void(size_t)>* task_ = nullptr;
+        std::atomic<size_t> remaining_{0};
+        uint64_t generation_ = 0;
+        bool stop_ = false;
+    };
+
+} // namespace platform
+
+#endif // PLATFORM_THREAD_POOL_HPP
@@ -0,0 +1,105 @@
+#include "tile_renderer.hpp"
+#include "profiler.hpp"
+#include "raster.hpp"
+#include <algorithm>
+
+namespace platform {
+
+TileRenderer::TileRenderer(size_t threads)
+    : threads_(0) {
+    set_thread_count(threads);
+}
+
+void TileRenderer::set_thread_count(size_t threads) {
+    threads = std::max<size_t>(threads, 1);
+    if (threads == threads_) {
+        return;
+    }
+    threads_ = threads;
+    pool_ = threads_ > 1 ? std::make_unique<ThreadPool>(threads_) : nullptr;
+}
+
+void TileRenderer::bin(const ShapeStore& store, const Bounds& extent) {
+    ENGINE_PROFILE_ZONE("bin shapes");
+    for (auto& tile : bins_) {
+        tile.clear();
+    }
+    const std::vector<uint8_t>& flags = store.columns().flags;
+    const size_t rows = store.rows();
+    for (size_t i = 0; i < rows; ++i) {
+        if (!(flags[i] & ShapeStore::VISIBLE)) {
+            continue;
+        }
+        Bounds b = store.bounds(static_cast<uint32_t>(i));
+        if (!b.intersects(extent)) {
+            continue;
+        }
+        b = b.clipped(extent.x1, extent.y1);
+        int tx0 = b.x0 / TILE_SIZE, tx1 = (b.x1 - 1) / TILE_SIZE;
+        int ty0 = b.y0 / TILE_SIZE, ty1 = (b.y1 - 1) / TILE_SIZE;
+        for (int ty = ty0; ty <= ty1; ++ty) {
+            for (int tx = tx0; tx <= tx1; ++tx) {
+                bins_[static_cast<size_t>(ty) * tiles_x_ + tx].push_back(static_cast<uint32_t>(i));
+            }
+        }
+    }
+}
+
+void TileRenderer::render(const Framebuffer& fb, const ShapeStore& store, const std::vector<Bounds>& rects, uint32_t background) {
+    ENGINE_PROFILE_ZONE("rasterize");
+    if (!pool_) {
+        for (const Bounds& rect : rects) {
+            raster_scene(fb, store, rect, background);
+        }
+        return;
+    }
+
+    tiles_x_ = (fb.width + TILE_SIZE - 1) / TILE_SIZE;
+    tiles_y_ = (fb.height + TILE_SIZE - 1) / TILE_SIZE;
+    bins_.resize(static_cast<size_t>(tiles_x_) * tiles_y_);
+
+    Bounds extent{0, 0, 0, 0};
+    bool any = false;
+    for (const Bounds& rect : rects) {
+        Bounds clipped = rect.clipped(fb.width, fb.height);
+        if (clipped.empty()) {
+            continue;
+        }
+        extent = any ? extent.united(clipped) : clipped;
+        any = true;
+    }
+    if (!any) {
+        return;
+    }
+    bin(store, extent);
+
+    work_.clear();
+    for (int ty = extent.y0 / TILE_SIZE; ty <= (extent.y1 - 1) / TILE_SIZE; ++ty) {
+        for (int tx = extent.x0 / TILE_SIZE; tx <= (extent.x1 - 1) / TILE_SIZE; ++tx) {
+            Bounds tile{tx * TILE_SIZE, ty * TILE_SIZE, (tx + 1) * TILE_SIZE, (ty + 1) * TILE_SIZE};
+            if (std::any_of(rects.begin(), rects.end(), [&](const Bounds& r) { return r.intersects(tile); })) {
+                work_.push_back(static_cast<uint32_t>(ty * tiles_x_ + tx));
+            }
+        }
+    }
+
+    pool_->run(work_.size(), [&](size_t task) {
+        ENGINE_PROFILE_ZONE("tile");
+        uint32_t index = work_[task];
+        int tx = static_cast<int>(index % tiles_x_), ty = static_cast<int>(index / tiles_x_);
+        Bounds tile{tx * TILE_SIZE, ty * TILE_SIZE, (tx + 1) * TILE_SIZE, (ty + 1) * TILE_SIZE};
+        const std::vector<uint32_t>& bin = bins_[index];
+        // Same order of rects as the single-threaded path, so overlapping
+        // damage rects repaint identically.
+        for (const Bounds& rect : rects) {
+            if (!rect.intersects(tile)) {
+                continue;
+            }
+            Bounds clip{std::max(rect.x0, tile.x0), std::max(rect.y0, tile.y0),
+                        std::min(rect.x1, tile.x1), std::min(rect.y1, tile.y1)};
+            raster_rows(fb, store, bin.data(), bin.size(), clip, background);
+        }
+    });
+}
+
+} // namespace platform
@@ -0,0 +1,43 @@
+#ifndef PLATFORM_TILE_RENDERER_HPP
+#define PLATFORM_TILE_RENDERER_HPP
+
+#include "framebuffer.hpp"
+#include "geometry.hpp"
+#include "shape_store.hpp"
+#include "thread_pool.hpp"
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace platform {
+
+    // Multi-threaded front end for the CPU rasterizer. Visible shapes are
+    // binned by bounding box into TILE_SIZE square screen tiles, keeping
+    // draw order inside each bin, and tiles are rasterized in parallel on a
+    // work-stealing pool. Every primitive is clip-exact, so the frame is
+    // byte-identical to a single-threaded raster_scene() over the same rects.
+    class TileRenderer {
+    public:
+        static constexpr int TILE_SIZE = 64;
+
+        explicit TileRenderer(size_t threads = 1);
+
+        // Total rasterizing threads, including the caller. 1 renders inline.
+        void set_thread_count(size_t threads);
+        size_t thread_count() const { return threads_; }
+
+        void render(const Framebuffer& fb, const ShapeStore& store, const std::vector<Bounds>& rects, uint32_t background);
+
+    private:
+        void bin(const ShapeStore& store, const Bounds& extent);
+
+        size_t threads_;
+        std::unique_ptr<ThreadPool> pool_;
+        int tiles_x_ = 0, tiles_y_ = 0;
+        std::vector<std::vector<uint32_t>> bins_; // Row indices per tile, reused across frames
+        std::vector<uint32_t> work_;              // Tiles touched by this frame's rects
+    };
+
+} // namespace platform
+
+#endif // PLATFORM_TILE_RENDERER_HPP
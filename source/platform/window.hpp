@@ -5,12 +5,20 @@
 #include <X11/Xlib.h>
 #include <X11/Xauth.h>
 #include <X11/Xatom.h>
+#include <xcb/xcb.h>
+#include <cstdint>
 #else
 #error "Platform not supported"
 #endif
 
 namespace platform {
 
+    enum class Backend {
+        X11,
+        XCB,     // libxcb without Xlib: pipelined requests, software rendering
+        HEADLESS // No display: in-memory framebuffer and injected events only
+    };
+
     // Configuration for window creation
     struct WindowConfig {
         const char* title = "Hello, World";
@@ -19,8 +27,17 @@ namespace platform {
         int width = 700;
         int height = 700;
         unsigned long background_color = 0xffffff; // White
+        // ENGINE_BACKEND=headless / xcb / x11 in the environment overrides this
+        Backend backend = Backend::X11;
     };
 
+    // Events the window's own connection selects, and the input events that
+    // move to a separate connection when Event runs an input thread (only
+    // one client may select button presses on a window).
+    constexpr long WINDOW_EVENT_MASK = ExposureMask | StructureNotifyMask;
+    constexpr long INPUT_EVENT_MASK = KeyPressMask | KeyReleaseMask | ButtonPressMask | ButtonReleaseMask |
+                                      PointerMotionMask | FocusChangeMask;
+
     enum class State {
         RUNNING,
         CLOSE
@@ -31,15 +48,65 @@ namespace platform {
         Window(const WindowConfig& config = WindowConfig());
         ~Window();
 
+        // Maps the window and returns without waiting; the Renderer picks
+        // up the MapNotify / ConfigureNotify when it first presents.
         void show();
+        bool shown() const { return shown_; }
         State should_run() const;
+        // Makes should_run() report CLOSE; used by headless drivers.
+        void close() { closed_ = true; }
+        bool is_headless() const { return headless_; }
+        // Null / None for headless and XCB windows
         Display* get_display() const { return dpy_; }
         ::Window get_window() const { return wd_; }
+        // Size the window was created with; Renderer::width() / height()
+        // follow it as it is resized
+        int width() const { return width_; }
+        int height() const { return height_; }
+        // The X connection's socket, -1 when headless
+        int connection_fd() const;
+        // CLOCK_MONOTONIC time the constructor started, for startup timing
+        uint64_t created_ns() const { return created_ns_; }
+
+        // XCB backend. Null / 0 for the other backends.
+        bool is_xcb() const { return xcb_ != nullptr; }
+        xcb_connection_t* get_connection() const { return xcb_; }
+        xcb_window_t get_xcb_window() const { return xcb_window_; }
+        const xcb_screen_t* get_xcb_screen() const { return xcb_screen_; }
+        xcb_atom_t wm_delete_window() const { return wm_delete_window_; }
+        // Events xcb has already read off the socket are invisible to
+        // poll(); this moves the next one into a look-ahead slot and returns
+        // it, or null if there is none. Never reads the socket.
+        const xcb_generic_event_t* peek_xcb_event() const;
+        // The look-ahead event, else the next event (reading the socket
+        // only when read_socket is set). The caller frees it; null if none.
+        xcb_generic_event_t* next_xcb_event(bool read_socket) const;
+        // Unshifted keysym for a keycode. The keyboard mapping is requested
+        // with the other startup queries and its reply collected here on
+        // first use.
+        uint32_t xcb_keysym(xcb_keycode_t keycode) const;
 
     private:
+        void open_xcb(const WindowConfig& config);
+        void close_xcb();
+
         Display* dpy_;
         ::Window wd_;
         int scr_;
+        int width_, height_;
+        bool headless_;
+        bool closed_;
+        bool shown_;
+        uint64_t created_ns_;
+
+        xcb_connection_t* xcb_;
+        xcb_window_t xcb_window_;
+        xcb_screen_t* xcb_screen_;
+        xcb_atom_t wm_delete_window_;
+        mutable xcb_generic_event_t* lookahead_;
+        mutable xcb_get_keyboard_mapping_cookie_t keymap_cookie_;
+        mutable xcb_get_keyboard_mapping_reply_t* keymap_;
+        mutable bool keymap_requested_;
     };
 
 } // namespace platform
@@ -1,60 +1,171 @@
 #include "window.hpp"
+#include "input.hpp"
+#include "log.hpp"
+#include "x_traffic.hpp"
 #include <stdexcept>
-#include <iostream>
+#include <cstdlib>
+#include <cstring>
 
 namespace platform {
 
-    Window::Window(const WindowConfig& config) {
+    namespace {
+
+        enum StartupAtom {
+            WM_PROTOCOLS,
+            WM_DELETE_WINDOW,
+            NET_WM_NAME,
+            UTF8_STRING,
+            ATOM_COUNT
+        };
+
+        char* ATOM_NAMES[ATOM_COUNT] = {const_cast<char*>("WM_PROTOCOLS"), const_cast<char*>("WM_DELETE_WINDOW"),
+                                        const_cast<char*>("_NET_WM_NAME"), const_cast<char*>("UTF8_STRING")};
+
+        Backend requested_backend(const WindowConfig& config) {
+            const char* env = std::getenv("ENGINE_BACKEND");
+            if (env) {
+                if (std::strcmp(env, "headless") == 0) {
+                    return Backend::HEADLESS;
+                }
+                if (std::strcmp(env, "xcb") == 0) {
+                    return Backend::XCB;
+                }
+                if (std::strcmp(env, "x11") == 0) {
+                    return Backend::X11;
+                }
+                ENGINE_LOG_WARN("Ignoring unknown ENGINE_BACKEND={}; expected headless, xcb or x11", env);
+            }
+            return config.backend;
+        }
+
+    } // namespace
+
+    Window::Window(const WindowConfig& config)
+        : dpy_(nullptr),
+          wd_(0),
+          scr_(0),
+          width_(config.width),
+          height_(config.height),
+          headless_(false),
+          closed_(false),
+          shown_(false),
+          created_ns_(monotonic_ns()),
+          xcb_(nullptr),
+          xcb_window_(0),
+          xcb_screen_(nullptr),
+          wm_delete_window_(0),
+          lookahead_(nullptr),
+          keymap_cookie_{0},
+          keymap_(nullptr),
+          keymap_requested_(false) {
+        Backend backend = requested_backend(config);
+        if (backend == Backend::HEADLESS) {
+            headless_ = true;
+            ENGINE_LOG_INFO("Created headless window with size {}x{}", config.width, config.height);
+            return;
+        }
+        if (backend == Backend::XCB) {
+            open_xcb(config);
+            return;
+        }
+
         dpy_ = XOpenDisplay(nullptr);
         if (!dpy_) {
             throw std::runtime_error("ERROR: Failed to open X11 display");
         }
 
+        x_traffic_attach(dpy_);
+
         scr_ = XDefaultScreen(dpy_);
-        wd_ = XCreateSimpleWindow(dpy_, XRootWindow(dpy_, scr_),
-                                  config.x, config.y, config.width, config.height,
-                                  0, 0, config.background_color);
+        {
+            ENGINE_X_CALL(dpy_, "Window::Window XCreateSimpleWindow");
+            wd_ = XCreateSimpleWindow(dpy_, XRootWindow(dpy_, scr_),
+                                      config.x, config.y, config.width, config.height,
+                                      0, 0, config.background_color);
+        }
         if (!wd_) {
             XCloseDisplay(dpy_);
             throw std::runtime_error("ERROR: Failed to create X11 window");
         }
 
-        Atom del_window = XInternAtom(dpy_, "WM_DELETE_WINDOW", 0);
-        XSetWMProtocols(dpy_, wd_, &del_window, 1);
-
-        XSelectInput(dpy_, wd_, ExposureMask | KeyPressMask | ButtonPressMask);
-
+        ENGINE_X_CALL(dpy_, "Window::Window setup");
+        // Requests without replies go first, so they share the one round
+        // trip of the batched atom lookup (XSetWMProtocols would intern
+        // WM_PROTOCOLS on its own)
+        XSelectInput(dpy_, wd_, WINDOW_EVENT_MASK | INPUT_EVENT_MASK);
+        // Resizing keeps the contents; only what a larger window uncovers is exposed
+        XSetWindowAttributes attributes;
+        attributes.bit_gravity = NorthWestGravity;
+        XChangeWindowAttributes(dpy_, wd_, CWBitGravity, &attributes);
         XStoreName(dpy_, wd_, config.title);
+        Atom atoms[ATOM_COUNT];
+        if (XInternAtoms(dpy_, ATOM_NAMES, ATOM_COUNT, False, atoms)) {
+            XChangeProperty(dpy_, wd_, atoms[WM_PROTOCOLS], XA_ATOM, 32, PropModeReplace,
+                            reinterpret_cast<unsigned char*>(&atoms[WM_DELETE_WINDOW]), 1);
+            XChangeProperty(dpy_, wd_, atoms[NET_WM_NAME], atoms[UTF8_STRING], 8, PropModeReplace,
+                            reinterpret_cast<const unsigned char*>(config.title),
+                            static_cast<int>(std::strlen(config.title)));
+        } else {
+            ENGINE_LOG_WARN("Failed to intern window manager atoms");
+        }
 
-        std::cout << "Created window on screen " << scr_ << " with size "
-                  << config.width << "x" << config.height << std::endl;
+        ENGINE_LOG_INFO("Created window on screen {} with size {}x{}", scr_, config.width, config.height);
     }
 
     Window::~Window() {
+        if (xcb_) {
+            close_xcb();
+        }
         if (wd_ && dpy_) {
             XDestroyWindow(dpy_, wd_);
         }
         if (dpy_) {
             XCloseDisplay(dpy_);
         }
-        std::cout << "Destroyed window" << std::endl;
+        ENGINE_LOG_INFO("Destroyed window");
     }
 
     void Window::show() {
+        if (headless_) {
+            shown_ = true;
+            return;
+        }
+        if (xcb_) {
+            shown_ = true;
+            // The server's own Expose follows the map; no synthetic one needed
+            xcb_map_window(xcb_, xcb_window_);
+            xcb_flush(xcb_);
+            ENGINE_LOG_INFO("Mapped window to display");
+            return;
+        }
         if (!dpy_ || !wd_) {
             throw std::runtime_error("ERROR: Cannot show invalid window");
         }
+        ENGINE_X_CALL(dpy_, "Window::show");
+        // The server's own Expose follows the map; no synthetic one needed
         XMapWindow(dpy_, wd_);
         XFlush(dpy_);
-        std::cout << "Mapped window to display" << std::endl;
+        shown_ = true;
+        ENGINE_LOG_INFO("Mapped window to display");
+    }
 
-        // Force expose event
-        XExposeEvent ev = { Expose, 0, 1, dpy_, wd_, 0, 0, 800, 600, 0 };
-        XSendEvent(dpy_, wd_, False, ExposureMask, (XEvent*)&ev);
-        XFlush(dpy_);
+    int Window::connection_fd() const {
+        if (xcb_) {
+            return xcb_get_file_descriptor(xcb_);
+        }
+        return dpy_ ? ConnectionNumber(dpy_) : -1;
     }
 
     State Window::should_run() const {
+        if (closed_) {
+            return State::CLOSE;
+        }
+        if (headless_) {
+            return State::RUNNING;
+        }
+        if (xcb_) {
+            return xcb_connection_has_error(xcb_) ? State::CLOSE : State::RUNNING;
+        }
         return (dpy_ && wd_) ? State::RUNNING : State::CLOSE;
     }
 
@@ -0,0 +1,150 @@
+#include "window.hpp"
+#include "log.hpp"
+#include "x_traffic.hpp"
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+
+namespace platform {
+
+    namespace {
+
+        enum StartupAtom {
+            WM_PROTOCOLS,
+            WM_DELETE_WINDOW,
+            NET_WM_NAME,
+            UTF8_STRING,
+            ATOM_COUNT
+        };
+
+        const char* const ATOM_NAMES[ATOM_COUNT] = {"WM_PROTOCOLS", "WM_DELETE_WINDOW", "_NET_WM_NAME", "UTF8_STRING"};
+
+    } // namespace
+
+    void Window::open_xcb(const WindowConfig& config) {
+        int screen_number = 0;
+        xcb_ = xcb_connect(nullptr, &screen_number);
+        if (xcb_connection_has_error(xcb_)) {
+            xcb_disconnect(xcb_);
+            xcb_ = nullptr;
+            throw std::runtime_error("ERROR: Failed to connect to the X server over XCB");
+        }
+        const xcb_setup_t* setup = xcb_get_setup(xcb_);
+        xcb_screen_iterator_t screens = xcb_setup_roots_iterator(setup);
+        for (int i = 0; i < screen_number && screens.rem; ++i) {
+            xcb_screen_next(&screens);
+        }
+        xcb_screen_ = screens.data;
+        scr_ = screen_number;
+
+        static const size_t site = x_traffic_site("Window::open_xcb");
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        // Every query that needs a reply goes out before any reply is
+        // waited for, so startup costs a single round trip
+        xcb_intern_atom_cookie_t atom_cookies[ATOM_COUNT];
+        for (int i = 0; i < ATOM_COUNT; ++i) {
+            atom_cookies[i] = xcb_intern_atom(xcb_, 0, static_cast<uint16_t>(std::strlen(ATOM_NAMES[i])), ATOM_NAMES[i]);
+        }
+        keymap_cookie_ = xcb_get_keyboard_mapping(xcb_, setup->min_keycode,
+                                                  static_cast<uint8_t>(setup->max_keycode - setup->min_keycode + 1));
+        keymap_requested_ = true;
+        xcb_prefetch_maximum_request_length(xcb_);
+
+        xcb_window_ = xcb_generate_id(xcb_);
+        // Value order follows the bit order of the value mask. North-west
+        // bit gravity keeps the contents on resize, as for Xlib windows
+        uint32_t values[] = {static_cast<uint32_t>(config.background_color), XCB_GRAVITY_NORTH_WEST,
+                             static_cast<uint32_t>(WINDOW_EVENT_MASK | INPUT_EVENT_MASK)};
+        xcb_create_window(xcb_, XCB_COPY_FROM_PARENT, xcb_window_, xcb_screen_->root,
+                          static_cast<int16_t>(config.x), static_cast<int16_t>(config.y),
+                          static_cast<uint16_t>(config.width), static_cast<uint16_t>(config.height), 0,
+                          XCB_WINDOW_CLASS_INPUT_OUTPUT, xcb_screen_->root_visual,
+                          XCB_CW_BACK_PIXEL | XCB_CW_BIT_GRAVITY | XCB_CW_EVENT_MASK, values);
+        xcb_change_property(xcb_, XCB_PROP_MODE_REPLACE, xcb_window_, XCB_ATOM_WM_NAME, XCB_ATOM_STRING, 8,
+                            static_cast<uint32_t>(std::strlen(config.title)), config.title);
+
+        xcb_atom_t atoms[ATOM_COUNT];
+        for (int i = 0; i < ATOM_COUNT; ++i) {
+            xcb_intern_atom_reply_t* reply = xcb_intern_atom_reply(xcb_, atom_cookies[i], nullptr);
+            atoms[i] = reply ? reply->atom : static_cast<xcb_atom_t>(XCB_ATOM_NONE);
+            std::free(reply);
+        }
+        wm_delete_window_ = atoms[WM_DELETE_WINDOW];
+        xcb_change_property(xcb_, XCB_PROP_MODE_REPLACE, xcb_window_, atoms[WM_PROTOCOLS], XCB_ATOM_ATOM, 32, 1,
+                            &wm_delete_window_);
+        xcb_void_cookie_t last = xcb_change_property(xcb_, XCB_PROP_MODE_REPLACE, xcb_window_, atoms[NET_WM_NAME],
+                                                     atoms[UTF8_STRING], 8,
+                                                     static_cast<uint32_t>(std::strlen(config.title)), config.title);
+        xcb_flush(xcb_);
+
+        // Request bytes are not counted here; xcb has no flush hook
+        XTrafficCounters traffic;
+        traffic.calls = 1;
+        traffic.requests = last.sequence - atom_cookies[0].sequence + 1;
+        traffic.flushes = 2;
+        traffic.round_trips = 1;
+        traffic.blocked_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count());
+        x_traffic_record(site, traffic);
+
+        ENGINE_LOG_INFO("Created XCB window on screen {} with size {}x{}", scr_, config.width, config.height);
+    }
+
+    void Window::close_xcb() {
+        std::free(lookahead_);
+        lookahead_ = nullptr;
+        if (keymap_requested_) {
+            xcb_discard_reply(xcb_, keymap_cookie_.sequence);
+        }
+        std::free(keymap_);
+        keymap_ = nullptr;
+        if (xcb_window_) {
+            xcb_destroy_window(xcb_, xcb_window_);
+        }
+        xcb_disconnect(xcb_);
+        xcb_ = nullptr;
+    }
+
+    const xcb_generic_event_t* Window::peek_xcb_event() const {
+        if (!lookahead_) {
+            lookahead_ = xcb_poll_for_queued_event(xcb_);
+        }
+        return lookahead_;
+    }
+
+    xcb_generic_event_t* Window::next_xcb_event(bool read_socket) const {
+        if (lookahead_) {
+            xcb_generic_event_t* event = lookahead_;
+            lookahead_ = nullptr;
+            return event;
+        }
+        return read_socket ? xcb_poll_for_event(xcb_) : xcb_poll_for_queued_event(xcb_);
+    }
+
+    uint32_t Window::xcb_keysym(xcb_keycode_t keycode) const {
+        if (keymap_requested_) {
+            static const size_t site = x_traffic_site("Window::xcb_keysym xcb_get_keyboard_mapping");
+            std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+            keymap_ = xcb_get_keyboard_mapping_reply(xcb_, keymap_cookie_, nullptr);
+            keymap_requested_ = false;
+            XTrafficCounters traffic;
+            traffic.calls = 1;
+            traffic.round_trips = 1;
+            traffic.blocked_ns = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - start).count());
+            x_traffic_record(site, traffic);
+        }
+        const xcb_setup_t* setup = xcb_get_setup(xcb_);
+        if (!keymap_ || keycode < setup->min_keycode) {
+            return 0;
+        }
+        int index = (keycode - setup->min_keycode) * keymap_->keysyms_per_keycode;
+        if (index >= xcb_get_keyboard_mapping_keysyms_length(keymap_)) {
+            return 0;
+        }
+        return xcb_get_keyboard_mapping_keysyms(keymap_)[index];
+    }
+
+} // namespace platform
\ No newline at end of file
@@ -0,0 +1,108 @@
+#ifndef PLATFORM_X_TRAFFIC_HPP
+#define PLATFORM_X_TRAFFIC_HPP
+
+#include <X11/Xlib.h>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace platform {
+
+    // What instrumented code cost on the X connection.
+    struct XTrafficCounters {
+        uint64_t calls = 0;       // Times the call site ran
+        uint64_t requests = 0;    // Requests issued
+        uint64_t bytes = 0;       // Request bytes queued for the server
+        uint64_t flushes = 0;     // Writes of the output buffer to the socket
+        uint64_t round_trips = 0; // Calls that waited for a reply to their own request
+        uint64_t blocked_ns = 0;  // Time in calls that wrote to or read from the socket
+
+        void add(const XTrafficCounters& other);
+    };
+
+    struct XTrafficSite {
+        std::string site;
+        XTrafficCounters total;
+        uint64_t frames;                // Frames in which the site ran
+        uint64_t max_frame_requests;    // Worst single frame
+        uint64_t max_frame_round_trips;
+    };
+
+    struct XTrafficReport {
+        uint64_t frames;                 // Presented frames
+        XTrafficCounters total;          // Everything, including startup and idle waits
+        XTrafficCounters last_frame;     // The most recent presented frame
+        XTrafficCounters max_frame;      // Per-field maximum over presented frames
+        std::vector<XTrafficSite> sites; // Most requests first
+    };
+
+    // X request accounting per call site and per frame, always on.
+    //
+    // Instrumented call sites (ENGINE_X_CALL) read the Xlib request
+    // sequence number, the output buffer fill and the time around the
+    // call. Bytes come from an Xlib flush hook on the window's connection,
+    // so they are exact, including deferred GC changes once flushed with
+    // XFlushGC. A call counts as a round trip when Xlib read the reply (or
+    // error) to a request the call itself issued, e.g. XSync, XAllocColor,
+    // XGetImage; XPending and friends show up as flushes instead.
+    //
+    // Scopes must not nest: the outer one would count the inner traffic
+    // again. Accounting is not thread-safe; only the thread that owns the
+    // window's connection records, which leaves out the input thread's
+    // own connection. XCB call sites report their counts themselves
+    // through x_traffic_record(); xcb has no flush hook, so there only
+    // image uploads count bytes.
+    //
+    // Renderer::present() ends a frame. If ENGINE_X_TRAFFIC=<path> is set,
+    // the report is written there at exit, as JSON for .json paths and as
+    // CSV otherwise.
+
+    // Installs the flush hook that counts bytes. Called by Window.
+    void x_traffic_attach(Display* dpy);
+    // Index of a call site by name; `name` must be a literal.
+    size_t x_traffic_site(const char* name);
+    // Adds traffic measured by the caller, e.g. for XCB requests.
+    void x_traffic_record(size_t site, const XTrafficCounters& counters);
+    void x_traffic_end_frame();
+    // Drops the traffic since the last frame from the per-frame figures
+    // (it stays in the totals), as FrameStats::skip_frame() does.
+    void x_traffic_skip_frame();
+    void x_traffic_reset();
+    XTrafficReport x_traffic_report();
+    std::string x_traffic_to_csv(const XTrafficReport& report);
+    std::string x_traffic_to_json(const XTrafficReport& report);
+    // On-demand dump; JSON for .json paths, CSV otherwise.
+    bool x_traffic_write(const std::string& path);
+
+    class XCallScope {
+    public:
+        XCallScope(Display* dpy, size_t site);
+        ~XCallScope();
+        XCallScope(const XCallScope&) = delete;
+        XCallScope& operator=(const XCallScope&) = delete;
+
+    private:
+        Display* dpy_;
+        size_t site_;
+        unsigned long first_request_;
+        unsigned long last_read_;
+        int queued_events_;
+        uint64_t queued_;
+        uint64_t flushes_;
+        std::chrono::steady_clock::time_point start_;
+    };
+
+} // namespace platform
+
+#define ENGINE_X_TRAFFIC_CONCAT_(a, b) a##b
+#define ENGINE_X_TRAFFIC_CONCAT(a, b) ENGINE_X_TRAFFIC_CONCAT_(a, b)
+
+// Accounts the X traffic of the rest of the enclosing scope to a named
+// call site. A null display (headless) records nothing.
+#define ENGINE_X_CALL(dpy, name)                                                                       \
+    static const size_t ENGINE_X_TRAFFIC_CONCAT(x_site_, __LINE__) = ::platform::x_traffic_site(name); \
+    ::platform::XCallScope ENGINE_X_TRAFFIC_CONCAT(x_call_, __LINE__)(dpy, ENGINE_X_TRAFFIC_CONCAT(x_site_, __LINE__))
+
+#endif // PLATFORM_X_TRAFFIC_HPP
\ No newline at end of file
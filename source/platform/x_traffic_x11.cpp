@@ -0,0 +1,311 @@
+#include "x_traffic.hpp"
+#include "log.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+// Last: Xlibint.h defines min and max as macros
+#include <X11/Xlibint.h>
+#undef min
+#undef max
+
+namespace platform {
+
+namespace {
+
+    struct Connection {
+        Display* dpy;
+        uint64_t flushed_bytes;
+        uint64_t flushes;
+    };
+
+    struct Site {
+        const char* name;
+        XTrafficCounters total;
+        XTrafficCounters frame; // Since the last end or skip of a frame
+        uint64_t frames;
+        uint64_t max_frame_requests;
+        uint64_t max_frame_round_trips;
+    };
+
+    class Traffic {
+    public:
+        static Traffic& instance() {
+            static Traffic traffic;
+            return traffic;
+        }
+
+        std::vector<Connection> connections;
+        std::vector<Site> sites;
+        uint64_t frames = 0;
+        XTrafficCounters last_frame;
+        XTrafficCounters max_frame;
+
+        Connection* find(Display* dpy) {
+            for (Connection& connection : connections) {
+                if (connection.dpy == dpy) {
+                    return &connection;
+                }
+            }
+            return nullptr;
+        }
+
+        ~Traffic() {
+            if (const char* path = std::getenv("ENGINE_X_TRAFFIC")) {
+                x_traffic_write(path);
+            }
+        }
+
+    private:
+        Traffic() {
+            // Make sure the logger exists first, so it outlives the write
+            // at exit.
+            log_flush();
+        }
+    };
+
+    // Xlib hands every write to the socket to this hook, one call per
+    // iovec: the output buffer, then any request data sent in place (large
+    // images) and its padding. Only the first call of a write counts as a
+    // flush; padding is under 4 bytes and never starts one.
+    void count_flush(Display* dpy, XExtCodes*, const char* data, long len) {
+        Connection* connection = Traffic::instance().find(dpy);
+        if (!connection) {
+            return;
+        }
+        connection->flushed_bytes += static_cast<uint64_t>(len);
+        if (data == dpy->buffer || (dpy->bufptr == dpy->buffer && len >= 4)) {
+            connection->flushes++;
+        }
+    }
+
+    int forget_connection(Display* dpy, XExtCodes*) {
+        std::vector<Connection>& connections = Traffic::instance().connections;
+        connections.erase(std::remove_if(connections.begin(), connections.end(),
+                                         [dpy](const Connection& connection) { return connection.dpy == dpy; }),
+                          connections.end());
+        return 0;
+    }
+
+    // Bytes written plus bytes still waiting in the output buffer
+    uint64_t queued_bytes(Display* dpy, const Connection& connection) {
+        return connection.flushed_bytes + static_cast<uint64_t>(dpy->bufptr - dpy->buffer);
+    }
+
+    void fold_max(XTrafficCounters& max, const XTrafficCounters& frame) {
+        max.calls = std::max(max.calls, frame.calls);
+        max.requests = std::max(max.requests, frame.requests);
+        max.bytes = std::max(max.bytes, frame.bytes);
+        max.flushes = std::max(max.flushes, frame.flushes);
+        max.round_trips = std::max(max.round_trips, frame.round_trips);
+        max.blocked_ns = std::max(max.blocked_ns, frame.blocked_ns);
+    }
+
+    std::string counters_json(const XTrafficCounters& c) {
+        char buffer[256];
+        std::snprintf(buffer, sizeof(buffer),
+                      "\"calls\": %llu, \"requests\": %llu, \"bytes\": %llu, \"flushes\": %llu, "
+                      "\"round_trips\": %llu, \"blocked_ms\": %.4f",
+                      static_cast<unsigned long long>(c.calls), static_cast<unsigned long long>(c.requests),
+                      static_cast<unsigned long long>(c.bytes), static_cast<unsigned long long>(c.flushes),
+                      static_cast<unsigned long long>(c.round_trips), c.blocked_ns / 1e6);
+        return buffer;
+    }
+
+} // namespace
+
+void XTrafficCounters::add(const XTrafficCounters& other) {
+    calls += other.calls;
+    requests += other.requests;
+    bytes += other.bytes;
+    flushes += other.flushes;
+    round_trips += other.round_trips;
+    blocked_ns += other.blocked_ns;
+}
+
+void x_traffic_attach(Display* dpy) {
+    Traffic& traffic = Traffic::instance();
+    if (!dpy || traffic.find(dpy)) {
+        return;
+    }
+    XExtCodes* codes = XAddExtension(dpy);
+    if (!codes) {
+        ENGINE_LOG_WARN("X traffic accounting unavailable: no extension slot");
+        return;
+    }
+    XESetBeforeFlush(dpy, codes->extension, count_flush);
+    XESetCloseDisplay(dpy, codes->extension, forget_connection);
+    traffic.connections.push_back(Connection{dpy, 0, 0});
+}
+
+size_t x_traffic_site(const char* name) {
+    std::vector<Site>& sites = Traffic::instance().sites;
+    for (size_t i = 0; i < sites.size(); ++i) {
+        if (std::strcmp(sites[i].name, name) == 0) {
+            return i;
+        }
+    }
+    sites.push_back(Site{name, {}, {}, 0, 0, 0});
+    return sites.size() - 1;
+}
+
+void x_traffic_record(size_t site, const XTrafficCounters& counters) {
+    Site& entry = Traffic::instance().sites[site];
+    entry.total.add(counters);
+    entry.frame.add(counters);
+}
+
+void x_traffic_end_frame() {
+    Traffic& traffic = Traffic::instance();
+    XTrafficCounters frame;
+    for (Site& site : traffic.sites) {
+        if (site.frame.calls == 0) {
+            continue;
+        }
+        frame.add(site.frame);
+        site.frames++;
+        site.max_frame_requests = std::max(site.max_frame_requests, site.frame.requests);
+        site.max_frame_round_trips = std::max(site.max_frame_round_trips, site.frame.round_trips);
+        site.frame = XTrafficCounters{};
+    }
+    traffic.frames++;
+    traffic.last_frame = frame;
+    fold_max(traffic.max_frame, frame);
+}
+
+void x_traffic_skip_frame() {
+    for (Site& site : Traffic::instance().sites) {
+        site.frame = XTrafficCounters{};
+    }
+}
+
+void x_traffic_reset() {
+    Traffic& traffic = Traffic::instance();
+    for (Site& site : traffic.sites) {
+        site = Site{site.name, {}, {}, 0, 0, 0};
+    }
+    traffic.frames = 0;
+    traffic.last_frame = XTrafficCounters{};
+    traffic.max_frame = XTrafficCounters{};
+}
+
+XTrafficReport x_traffic_report() {
+    Traffic& traffic = Traffic::instance();
+    XTrafficReport report;
+    report.frames = traffic.frames;
+    report.total = XTrafficCounters{};
+    report.last_frame = traffic.last_frame;
+    report.max_frame = traffic.max_frame;
+    for (const Site& site : traffic.sites) {
+        if (site.total.calls == 0) {
+            continue;
+        }
+        report.total.add(site.total);
+        report.sites.push_back(XTrafficSite{site.name, site.total, site.frames, site.max_frame_requests,
+                                            site.max_frame_round_trips});
+    }
+    std::stable_sort(report.sites.begin(), report.sites.end(), [](const XTrafficSite& a, const XTrafficSite& b) {
+        return a.total.requests > b.total.requests;
+    });
+    return report;
+}
+
+std::string x_traffic_to_csv(const XTrafficReport& report) {
+    std::string out = "site,calls,requests,bytes,flushes,round_trips,blocked_ms,frames,max_frame_requests,"
+                      "max_frame_round_trips\n";
+    char line[512];
+    auto row = [&](const char* name, const XTrafficCounters& c, uint64_t frames, uint64_t max_requests,
+                   uint64_t max_round_trips) {
+        std::snprintf(line, sizeof(line), "%s,%llu,%llu,%llu,%llu,%llu,%.4f,%llu,%llu,%llu\n", name,
+                      static_cast<unsigned long long>(c.calls), static_cast<unsigned long long>(c.requests),
+                      static_cast<unsigned long long>(c.bytes), static_cast<unsigned long long>(c.flushes),
+                      static_cast<unsigned long long>(c.round_trips), c.blocked_ns / 1e6,
+                      static_cast<unsigned long long>(frames), static_cast<unsigned long long>(max_requests),
+                      static_cast<unsigned long long>(max_round_trips));
+        out += line;
+    };
+    row("total", report.total, report.frames, report.max_frame.requests, report.max_frame.round_trips);
+    for (const XTrafficSite& site : report.sites) {
+        row(site.site.c_str(), site.total, site.frames, site.max_frame_requests, site.max_frame_round_trips);
+    }
+    return out;
+}
+
+std::string x_traffic_to_json(const XTrafficReport& report) {
+    std::string out = "{\"frames\": " + std::to_string(report.frames);
+    out += ", \"total\": {" + counters_json(report.total) + "}";
+    out += ", \"last_frame\": {" + counters_json(report.last_frame) + "}";
+    out += ", \"max_frame\": {" + counters_json(report.max_frame) + "}";
+    out += ", \"sites\": {";
+    for (size_t i = 0; i < report.sites.size(); ++i) {
+        const XTrafficSite& site = report.sites[i];
+        out += i ? ", \"" : "\"";
+        out += site.site + "\": {" + counters_json(site.total);
+        out += ", \"frames\": " + std::to_string(site.frames);
+        out += ", \"max_frame_requests\": " + std::to_string(site.max_frame_requests);
+        out += ", \"max_frame_round_trips\": " + std::to_string(site.max_frame_round_trips) + "}";
+    }
+    out += "}}\n";
+    return out;
+}
+
+bool x_traffic_write(const std::string& path) {
+    XTrafficReport report = x_traffic_report();
+    bool json = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+    std::ofstream file(path, std::ios::trunc);
+    file << (json ? x_traffic_to_json(report) : x_traffic_to_csv(report));
+    if (!file) {
+        ENGINE_LOG_WARN("Failed to write X traffic to {}", path);
+        return false;
+    }
+    return true;
+}
+
+XCallScope::XCallScope(Display* dpy, size_t site)
+    : dpy_(dpy),
+      site_(site),
+      first_request_(0),
+      last_read_(0),
+      queued_events_(0),
+      queued_(0),
+      flushes_(0) {
+    if (!dpy_) {
+        return;
+    }
+    if (const Connection* connection = Traffic::instance().find(dpy_)) {
+        queued_ = queued_bytes(dpy_, *connection);
+        flushes_ = connection->flushes;
+    }
+    first_request_ = XNextRequest(dpy_);
+    last_read_ = XLastKnownRequestProcessed(dpy_);
+    queued_events_ = dpy_->qlen;
+    start_ = std::chrono::steady_clock::now();
+}
+
+XCallScope::~XCallScope() {
+    if (!dpy_) {
+        return;
+    }
+    std::chrono::steady_clock::time_point end = std::chrono::steady_clock::now();
+    XTrafficCounters counters;
+    counters.calls = 1;
+    counters.requests = XNextRequest(dpy_) - first_request_;
+    if (const Connection* connection = Traffic::instance().find(dpy_)) {
+        counters.bytes = queued_bytes(dpy_, *connection) - queued_;
+        counters.flushes = connection->flushes - flushes_;
+    }
+    // Reading the reply to one of our own requests means we waited for
+    // it, unless an event the request caused (MapNotify after XMapWindow)
+    // moved the serial instead; reading anything at all means socket I/O
+    unsigned long last_read = XLastKnownRequestProcessed(dpy_);
+    bool event_serial = dpy_->qlen > queued_events_ && dpy_->tail && dpy_->tail->event.xany.serial == last_read;
+    counters.round_trips = counters.requests > 0 && last_read >= first_request_ && !event_serial ? 1 : 0;
+    if (counters.flushes || last_read != last_read_) {
+        counters.blocked_ns = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(end - start_).count());
+    }
+    x_traffic_record(site_, counters);
+}
+
+} // namespace platform
\ No newline at end of file
@@ -0,0 +1,132 @@
+#include "xcb_surface.hpp"
+#include "log.hpp"
+#include "x_traffic.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <stdexcept>
+
+namespace platform {
+
+namespace {
+
+// Visual of the screen's root window, or null
+const xcb_visualtype_t* root_visual(const xcb_screen_t* screen) {
+    for (xcb_depth_iterator_t depth = xcb_screen_allowed_depths_iterator(screen); depth.rem; xcb_depth_next(&depth)) {
+        for (xcb_visualtype_iterator_t visual = xcb_depth_visuals_iterator(depth.data); visual.rem;
+             xcb_visualtype_next(&visual)) {
+            if (visual.data->visual_id == screen->root_visual) {
+                return visual.data;
+            }
+        }
+    }
+    return nullptr;
+}
+
+uint8_t bits_per_pixel(const xcb_setup_t* setup, uint8_t depth) {
+    for (xcb_format_iterator_t format = xcb_setup_pixmap_formats_iterator(setup); format.rem; xcb_format_next(&format)) {
+        if (format.data->depth == depth) {
+            return format.data->bits_per_pixel;
+        }
+    }
+    return 0;
+}
+
+// PutImage request header, in bytes
+constexpr size_t PUT_IMAGE_HEADER = 24;
+
+uint64_t elapsed_ns(std::chrono::steady_clock::time_point start) {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - start).count());
+}
+
+} // namespace
+
+XcbSurface::XcbSurface(const Window& window)
+    : c_(window.get_connection()),
+      window_(window.get_xcb_window()),
+      gc_(0),
+      depth_(window.get_xcb_screen()->root_depth),
+      max_request_bytes_(0) {
+    const xcb_setup_t* setup = xcb_get_setup(c_);
+    const xcb_visualtype_t* visual = root_visual(window.get_xcb_screen());
+    if (!visual || visual->_class != XCB_VISUAL_CLASS_TRUE_COLOR || visual->red_mask != 0xff0000 ||
+        visual->green_mask != 0x00ff00 || visual->blue_mask != 0x0000ff ||
+        bits_per_pixel(setup, depth_) != 32 || setup->image_byte_order != XCB_IMAGE_ORDER_LSB_FIRST) {
+        throw std::runtime_error("ERROR: XCB backend needs a 24-bit TrueColor visual with 32-bit LSB-first pixels");
+    }
+    gc_ = xcb_generate_id(c_);
+    uint32_t values[] = {0};
+    xcb_create_gc(c_, gc_, window_, XCB_GC_GRAPHICS_EXPOSURES, values);
+}
+
+XcbSurface::~XcbSurface() {
+    if (gc_) {
+        xcb_free_gc(c_, gc_);
+    }
+}
+
+void XcbSurface::publish(const Framebuffer& fb, const std::vector<Bounds>& rects) {
+    static const size_t site = x_traffic_site("XcbSurface::publish xcb_put_image");
+    XTrafficCounters traffic;
+    traffic.calls = 1;
+    if (!max_request_bytes_) {
+        // Collects the BIG-REQUESTS reply prefetched at startup
+        std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        max_request_bytes_ = static_cast<size_t>(xcb_get_maximum_request_length(c_)) * 4;
+        traffic.round_trips = 1;
+        traffic.blocked_ns = elapsed_ns(start);
+    }
+    for (const Bounds& rect : rects) {
+        int width = rect.x1 - rect.x0;
+        if (width <= 0 || rect.y1 <= rect.y0) {
+            continue;
+        }
+        size_t row_bytes = static_cast<size_t>(width) * 4;
+        int band = static_cast<int>(std::max<size_t>((max_request_bytes_ - PUT_IMAGE_HEADER) / row_bytes, 1));
+        for (int y = rect.y0; y < rect.y1; y += band) {
+            int rows = std::min(band, rect.y1 - y);
+            const uint32_t* data;
+            if (rect.x0 == 0 && width == fb.stride) {
+                // Whole rows are contiguous in the framebuffer already
+                data = fb.row(y);
+            } else {
+                staging_.resize(static_cast<size_t>(width) * rows);
+                for (int r = 0; r < rows; ++r) {
+                    const uint32_t* src = fb.row(y + r) + rect.x0;
+                    std::copy(src, src + width, staging_.begin() + static_cast<size_t>(r) * width);
+                }
+                data = staging_.data();
+            }
+            xcb_put_image(c_, XCB_IMAGE_FORMAT_Z_PIXMAP, window_, gc_, static_cast<uint16_t>(width),
+                          static_cast<uint16_t>(rows), static_cast<int16_t>(rect.x0), static_cast<int16_t>(y), 0,
+                          depth_, static_cast<uint32_t>(row_bytes * rows), reinterpret_cast<const uint8_t*>(data));
+            // Requests past 256 KB carry the BIG-REQUESTS length word
+            size_t bytes = PUT_IMAGE_HEADER + row_bytes * rows;
+            traffic.requests++;
+            traffic.bytes += bytes + (bytes > 0x3ffff ? 4 : 0);
+        }
+    }
+    x_traffic_record(site, traffic);
+}
+
+void XcbSurface::flush(bool confirm) {
+    static const size_t site = x_traffic_site("XcbSurface::flush xcb_flush");
+    XTrafficCounters traffic;
+    traffic.calls = 1;
+    traffic.flushes = 1;
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    if (!confirm) {
+        xcb_flush(c_);
+    } else {
+        // Any request with a reply works as a barrier; GetInputFocus is the cheapest
+        std::free(xcb_get_input_focus_reply(c_, xcb_get_input_focus(c_), nullptr));
+        traffic.requests = 1;
+        traffic.bytes = 4;
+        traffic.round_trips = 1;
+    }
+    traffic.blocked_ns = elapsed_ns(start);
+    x_traffic_record(site, traffic);
+}
+
+} // namespace platform
\ No newline at end of file
@@ -0,0 +1,42 @@
+#ifndef PLATFORM_XCB_SURFACE_HPP
+#define PLATFORM_XCB_SURFACE_HPP
+
+#include "window.hpp"
+#include "framebuffer.hpp"
+#include "geometry.hpp"
+#include <cstddef>
+#include <vector>
+
+namespace platform {
+
+    // Publishes a client-side framebuffer to an XCB window with PutImage.
+    // Requests carry no reply, so a frame costs no round trip: the image
+    // data is queued and written out by flush(). Rects too large for one
+    // request are split into bands of rows; the maximum request length is
+    // prefetched at startup and only collected on the first publish.
+    // Needs a 24-bit TrueColor visual stored as 32 bits per pixel, which
+    // matches the 0x00RRGGBB framebuffer directly.
+    class XcbSurface {
+    public:
+        explicit XcbSurface(const Window& window);
+        ~XcbSurface();
+        XcbSurface(const XcbSurface&) = delete;
+        XcbSurface& operator=(const XcbSurface&) = delete;
+
+        void publish(const Framebuffer& fb, const std::vector<Bounds>& rects);
+        // With confirm, waits for a reply so every request sent so far has
+        // been executed; otherwise just writes them out.
+        void flush(bool confirm);
+
+    private:
+        xcb_connection_t* c_;
+        xcb_window_t window_;
+        xcb_gcontext_t gc_;
+        uint8_t depth_;
+        size_t max_request_bytes_; // 0 until the first publish
+        std::vector<uint32_t> staging_;
+    };
+
+} // namespace platform
+
+#endif // PLATFORM_XCB_SURFACE_HPP
\ No newline at end of file
@@ -1,13 +1,15 @@
 #include <platform/event.hpp>
+#include <platform/fixed_timestep.hpp>
+#include <platform/frame_scheduler.hpp>
 #include <iostream>
 #include <chrono>
-#include <thread>
 #include <random>
 #include <vector>
 #include <algorithm>
+#include <string>
 
 struct Pipe {
-    int x; // X position of pipe pair
+    float x, prev_x; // X position of pipe pair, now and one step ago
     int gap_y; // Y position of gap center
     int id_top, id_bottom; // IDs for top and bottom pipe rectangles
     bool scored; // Whether bird passed this pipe
@@ -15,19 +17,47 @@ struct Pipe {
 
 struct Bird {
     float x, y; // Position
+    float prev_y; // Y one simulation step ago, for interpolation
     float velocity; // Vertical velocity
     int id; // ID for rectangle
 };
 
-int main() {
+int main(int argc, char** argv) {
     try {
+        // --software renders on the CPU and uploads frames via MIT-SHM.
+        // --headless runs an unpaced soak without a display, flapping on a
+        // fixed schedule, and reports frames per second.
+        // --threads=N sets the number of software rasterizer threads.
+        bool software = false;
+        bool headless = false;
+        long soak_frames = 10000;
+        long render_threads = 0;
+        for (int i = 1; i < argc; ++i) {
+            std::string arg = argv[i];
+            if (arg == "--software") {
+                software = true;
+            } else if (arg == "--headless") {
+                headless = true;
+            } else if (arg.rfind("--frames=", 0) == 0) {
+                soak_frames = std::stol(arg.substr(9));
+            } else if (arg.rfind("--threads=", 0) == 0) {
+                render_threads = std::stol(arg.substr(10));
+            }
+        }
+
         platform::WindowConfig config;
         config.title = "Flappy Bird with X11 Renderer";
         config.width = 800;
         config.height = 600;
+        if (headless) {
+            config.backend = platform::Backend::HEADLESS;
+        }
 
         platform::Window window(config);
-        platform::Renderer renderer(window);
+        platform::Renderer renderer(window, software ? platform::RenderMode::SOFTWARE : platform::RenderMode::XLIB);
+        if (render_threads > 0) {
+            renderer.set_thread_count(static_cast<size_t>(render_threads));
+        }
         window.show();
 
         // Initial rendering (static shapes)
@@ -48,143 +78,203 @@ int main() {
         }
         renderer.present();
 
-        // Game state
-        Bird bird{200.0f, 300.0f, 0.0f, 3}; // Start at (200, 300), ID 3
+        // Game state. Physics runs in fixed 120 Hz steps with per-second
+        // units, so game speed does not depend on the frame rate.
+        Bird bird{200.0f, 300.0f, 300.0f, 0.0f, 3}; // Start at (200, 300), ID 3
         std::vector<Pipe> pipes;
         bool game_over = false;
         int score = 0;
-        const float gravity = 0.5f;
-        const float flap_velocity = -10.0f;
+        const float gravity = 1800.0f; // px/s^2
+        const float flap_velocity = -600.0f; // px/s
         const int pipe_width = 50;
         const int gap_size = 150;
         const int pipe_spacing = 200;
-        const float pipe_speed = 2.0f;
+        const float pipe_speed = 120.0f; // px/s
+        platform::FixedTimestep timestep(120.0, 8);
+        const float dt = static_cast<float>(timestep.step());
 
         // Random number generator for gap positions
         std::random_device rd;
         std::mt19937 gen(rd());
         std::uniform_int_distribution<> gap_dist(100, config.height - 150); // Gap center range
 
+        // Pipes are drawn once when spawned and moved in place afterwards
+        auto spawn_pipe = [&](int id_top) {
+            float x = static_cast<float>(config.width);
+            Pipe pipe{x, x, gap_dist(gen), id_top, id_top + 1, false};
+            renderer.set_draw_color(0, 255, 0, 255); // Green pipes
+            // Top pipe (from top to gap_y - gap_size/2)
+            renderer.draw_rect(config.width, 0, pipe_width, pipe.gap_y - gap_size / 2, true, pipe.id_top);
+            // Bottom pipe (from gap_y + gap_size/2 to ground)
+            renderer.draw_rect(config.width, pipe.gap_y + gap_size / 2, pipe_width, config.height - 50 - (pipe.gap_y + gap_size / 2), true, pipe.id_bottom);
+            pipes.push_back(pipe);
+        };
+
+        auto clear_pipes = [&]() {
+            for (const auto& pipe : pipes) {
+                renderer.remove_shape_by_id(pipe.id_top);
+                renderer.remove_shape_by_id(pipe.id_bottom);
+            }
+            pipes.clear();
+        };
+
+        // Bird
+        renderer.set_draw_color(255, 255, 0, 255); // Yellow bird
+        renderer.draw_rect(static_cast<int>(bird.x), static_cast<int>(bird.y), 20, 20, true, bird.id);
+
         // Spawn initial pipe
-        pipes.push_back({config.width, gap_dist(gen), 1000, 1001, false});
+        spawn_pipe(1000);
+
+        // One fixed simulation step
+        auto step = [&]() {
+            if (game_over) {
+                // Freeze the bird so the screen stops changing and the loop
+                // can sleep until the restart key
+                bird.prev_y = bird.y;
+                return;
+            }
+            // Update bird
+            bird.prev_y = bird.y;
+            bird.velocity += gravity * dt;
+            bird.y += bird.velocity * dt;
+
+            // Update pipes
+            for (auto& pipe : pipes) {
+                pipe.prev_x = pipe.x;
+                pipe.x -= pipe_speed * dt;
+
+                // Score when bird passes pipe
+                if (!pipe.scored && pipe.x + pipe_width < bird.x) {
+                    score++;
+                    pipe.scored = true;
+                    std::cout << "Score: " << score << std::endl;
+                }
+            }
+
+            // Spawn new pipe
+            if (!pipes.empty() && pipes.back().x <= config.width - pipe_spacing) {
+                spawn_pipe(pipes.back().id_top + 2);
+            }
+
+            // Remove off-screen pipes
+            pipes.erase(std::remove_if(pipes.begin(), pipes.end(),
+                [&](const Pipe& pipe) {
+                    if (pipe.x + pipe_width < 0) {
+                        renderer.remove_shape_by_id(pipe.id_top);
+                        renderer.remove_shape_by_id(pipe.id_bottom);
+                        return true;
+                    }
+                    return false;
+                }), pipes.end());
+
+            // Collision detection
+            for (const auto& pipe : pipes) {
+                // Bird rectangle
+                int bx = static_cast<int>(bird.x);
+                int by = static_cast<int>(bird.y);
+                int bw = 20, bh = 20;
+                int px = static_cast<int>(pipe.x);
+                // Top pipe
+                int tx = px, ty = 0, tw = pipe_width, th = pipe.gap_y - gap_size / 2;
+                // Bottom pipe
+                int bx2 = px, by2 = pipe.gap_y + gap_size / 2, bw2 = pipe_width, bh2 = config.height - 50 - (pipe.gap_y + gap_size / 2);
+                // AABB collision
+                if ((bx < tx + tw && bx + bw > tx && by < ty + th && by + bh > ty) ||
+                    (bx < bx2 + bw2 && bx + bw > bx2 && by < by2 + bh2 && by + bh > by2)) {
+                    game_over = true;
+                    std::cout << "Game Over! Score: " << score << std::endl;
+                    // Clear pipes immediately
+                    clear_pipes();
+                    break;
+                }
+            }
+            // Ground and ceiling collision
+            if (!game_over && (bird.y + 20 > config.height - 50 || bird.y < 0)) {
+                game_over = true;
+                std::cout << "Game Over! Score: " << score << std::endl;
+                // Clear pipes immediately
+                clear_pipes();
+            }
+        };
 
         platform::Event event(window);
-        auto last_frame = std::chrono::steady_clock::now();
-        while (window.should_run() == platform::State::RUNNING) {
-            // Handle events
-            if (event.poll(renderer)) {
+        // The soak runs unpaced and advances a simulated 60 Hz clock, so
+        // its game play does not depend on how fast the machine is
+        platform::FrameScheduler scheduler(window, window.is_headless() ? 0.0 : 60.0);
+        scheduler.watch(event.wake_fd()); // ENGINE_INPUT_THREAD=1
+        auto soak_start = std::chrono::steady_clock::now();
+        auto last_frame = soak_start;
+        long frames = 0;
+        bool quit = false;
+        while (!quit && window.should_run() == platform::State::RUNNING) {
+            if (window.is_headless()) {
+                if (frames == soak_frames) {
+                    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - soak_start).count();
+                    std::cout << "Soak: " << frames << " frames in " << seconds << " s ("
+                              << frames / seconds << " fps)" << std::endl;
+                    std::cout << platform::FrameStats::to_csv(renderer.frame_stats().report());
+                    break;
+                }
+                if (frames % 25 == 0) {
+                    event.inject(platform::EventKind::KEY_SPACE);
+                }
+            }
+
+            // Sleep until the next frame or input, then handle all input.
+            // While the last frame changed nothing, sleep until input only.
+            bool idle = renderer.idle();
+            bool frame_due = scheduler.wait(idle) == platform::WakeReason::FRAME;
+            while (event.poll(renderer)) {
                 if (event.kind() == platform::EventKind::EXIT || event.kind() == platform::EventKind::KEY_ESC) {
                     std::cout << "Exiting" << std::endl;
+                    quit = true;
                     break;
                 }
                 if (event.kind() == platform::EventKind::KEY_SPACE) {
                     if (game_over) {
                         // Restart game
-                        bird = {200.0f, 300.0f, 0.0f, 3};
-                        for (const auto& pipe : pipes) {
-                            renderer.remove_shape_by_id(pipe.id_top);
-                            renderer.remove_shape_by_id(pipe.id_bottom);
-                        }
-                        pipes.clear();
-                        pipes.push_back({config.width, gap_dist(gen), 1000, 1001, false});
+                        bird = {200.0f, 300.0f, 300.0f, 0.0f, 3};
+                        clear_pipes();
+                        spawn_pipe(1000);
                         score = 0;
                         game_over = false;
+                        timestep.reset();
                     } else {
                         // Flap bird
                         bird.velocity = flap_velocity;
                     }
                 }
             }
-
-            // Update game (~60 FPS)
             auto now = std::chrono::steady_clock::now();
-            auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_frame).count();
-            if (delta >= 16) { // ~60 FPS
-                if (!game_over) {
-                    // Update bird
-                    bird.velocity += gravity;
-                    bird.y += bird.velocity;
-                    renderer.remove_shape_by_id(bird.id);
-                    renderer.set_draw_color(255, 255, 0, 255); // Yellow bird
-                    renderer.draw_rect(static_cast<int>(bird.x), static_cast<int>(bird.y), 20, 20, true, bird.id);
-
-                    // Update pipes
-                    for (auto& pipe : pipes) {
-                        pipe.x -= pipe_speed;
-                        renderer.remove_shape_by_id(pipe.id_top);
-                        renderer.remove_shape_by_id(pipe.id_bottom);
-                        renderer.set_draw_color(0, 255, 0, 255); // Green pipes
-                        // Top pipe (from top to gap_y - gap_size/2)
-                        renderer.draw_rect(pipe.x, 0, pipe_width, pipe.gap_y - gap_size / 2, true, pipe.id_top);
-                        // Bottom pipe (from gap_y + gap_size/2 to ground)
-                        renderer.draw_rect(pipe.x, pipe.gap_y + gap_size / 2, pipe_width, config.height - 50 - (pipe.gap_y + gap_size / 2), true, pipe.id_bottom);
-
-                        // Score when bird passes pipe
-                        if (!pipe.scored && pipe.x + pipe_width < bird.x) {
-                            score++;
-                            pipe.scored = true;
-                            std::cout << "Score: " << score << std::endl;
-                        }
-                    }
-
-                    // Spawn new pipe
-                    if (!pipes.empty() && pipes.back().x <= config.width - pipe_spacing) {
-                        int new_id = pipes.back().id_top + 2;
-                        pipes.push_back({config.width, gap_dist(gen), new_id, new_id + 1, false});
-                    }
+            if (idle && !frame_due) {
+                // Woken from idle: draw right away, without catching up
+                last_frame = now;
+                frame_due = true;
+            }
+            if (!frame_due || quit) {
+                continue;
+            }
 
-                    // Remove off-screen pipes
-                    pipes.erase(std::remove_if(pipes.begin(), pipes.end(),
-                        [&](const Pipe& pipe) {
-                            if (pipe.x + pipe_width < 0) {
-                                renderer.remove_shape_by_id(pipe.id_top);
-                                renderer.remove_shape_by_id(pipe.id_bottom);
-                                return true;
-                            }
-                            return false;
-                        }), pipes.end());
-
-                    // Collision detection
-                    for (const auto& pipe : pipes) {
-                        // Bird rectangle
-                        int bx = static_cast<int>(bird.x);
-                        int by = static_cast<int>(bird.y);
-                        int bw = 20, bh = 20;
-                        // Top pipe
-                        int tx = pipe.x, ty = 0, tw = pipe_width, th = pipe.gap_y - gap_size / 2;
-                        // Bottom pipe
-                        int bx2 = pipe.x, by2 = pipe.gap_y + gap_size / 2, bw2 = pipe_width, bh2 = config.height - 50 - (pipe.gap_y + gap_size / 2);
-                        // AABB collision
-                        if ((bx < tx + tw && bx + bw > tx && by < ty + th && by + bh > ty) ||
-                            (bx < bx2 + bw2 && bx + bw > bx2 && by < by2 + bh2 && by + bh > by2)) {
-                            game_over = true;
-                            std::cout << "Game Over! Score: " << score << std::endl;
-                            // Clear pipes immediately
-                            for (const auto& pipe : pipes) {
-                                renderer.remove_shape_by_id(pipe.id_top);
-                                renderer.remove_shape_by_id(pipe.id_bottom);
-                            }
-                            pipes.clear();
-                        }
-                    }
-                    // Ground and ceiling collision
-                    if (bird.y + 20 > config.height - 50 || bird.y < 0) {
-                        game_over = true;
-                        std::cout << "Game Over! Score: " << score << std::endl;
-                        // Clear pipes immediately
-                        for (const auto& pipe : pipes) {
-                            renderer.remove_shape_by_id(pipe.id_top);
-                            renderer.remove_shape_by_id(pipe.id_bottom);
-                        }
-                        pipes.clear();
-                    }
-                }
+            // Simulate the elapsed time in fixed steps
+            double elapsed = window.is_headless() ? 1.0 / 60.0 : std::chrono::duration<double>(now - last_frame).count();
+            last_frame = now;
+            int steps = timestep.advance(elapsed);
+            for (int i = 0; i < steps; ++i) {
+                step();
+            }
 
-                renderer.present();
-                last_frame = now;
+            // Draw everything between its previous and current state
+            double alpha = timestep.alpha();
+            renderer.move_shape_by_id(bird.id, static_cast<int>(bird.x),
+                                      static_cast<int>(platform::lerp(bird.prev_y, bird.y, alpha)));
+            for (const auto& pipe : pipes) {
+                int x = static_cast<int>(platform::lerp(pipe.prev_x, pipe.x, alpha));
+                renderer.move_shape_by_id(pipe.id_top, x, 0);
+                renderer.move_shape_by_id(pipe.id_bottom, x, pipe.gap_y + gap_size / 2);
             }
 
-            std::this_thread::sleep_for(std::chrono::milliseconds(2));
+            frames++;
+            renderer.present();
         }
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;
@@ -1,7 +1,6 @@
 #include <platform/event.hpp>
+#include <platform/frame_scheduler.hpp>
 #include <iostream>
-#include <chrono>
-#include <thread>
 
 int main() {
     try {
@@ -39,22 +38,28 @@ int main() {
             {0, 0, 20, 20, 2, 2, 2, 255, 0, 0}, // Red square
             {100, 100, 30, 30, -3, 1, 3, 0, 255, 0}, // Green square
         };
+        for (const auto& rect : rects) {
+            renderer.set_draw_color(rect.r, rect.g, rect.b, 255);
+            renderer.draw_rect(rect.x, rect.y, rect.width, rect.height, true, rect.id);
+        }
 
         platform::Event event(window);
-        auto last_frame = std::chrono::steady_clock::now();
-        while (window.should_run() == platform::State::RUNNING) {
-            // Handle events
-            if (event.poll(renderer)) {
+        platform::FrameScheduler scheduler(window, 60.0);
+        scheduler.watch(event.wake_fd()); // ENGINE_INPUT_THREAD=1
+        bool quit = false;
+        while (!quit && window.should_run() == platform::State::RUNNING) {
+            // Sleep until the next frame or input, then handle all input
+            bool frame_due = scheduler.wait() == platform::WakeReason::FRAME;
+            while (event.poll(renderer)) {
                 if (event.kind() == platform::EventKind::EXIT || event.kind() == platform::EventKind::KEY_ESC) {
                     std::cout << "Exiting" << std::endl;
+                    quit = true;
                     break;
                 }
             }
 
             // Update animation (~60 FPS)
-            auto now = std::chrono::steady_clock::now();
-            auto delta = std::chrono::duration_cast<std::chrono::milliseconds>(now - last_frame).count();
-            if (delta >= 16) { // ~60 FPS (1000ms / 60)
+            if (frame_due && !quit) {
                 // Update animated rectangles
                 for (auto& rect : rects) {
                     rect.x += rect.speed_x;
@@ -64,20 +69,13 @@ int main() {
                     if (rect.y > config.height - rect.height) rect.y = 0;
                     if (rect.y < 0) rect.y = config.height - rect.height;
 
-                    // Update rectangle with ID
-                    renderer.remove_shape_by_id(rect.id);
-                    renderer.set_draw_color(rect.r, rect.g, rect.b, 255);
-                    renderer.draw_rect(rect.x, rect.y, rect.width, rect.height, true, rect.id);
+                    // Move rectangle with ID
+                    renderer.move_shape_by_id(rect.id, rect.x, rect.y);
                 }
 
                 // Redraw entire scene
                 renderer.present();
-
-                last_frame = now;
             }
-
-            // Stabilize frame rate
-            std::this_thread::sleep_for(std::chrono::milliseconds(2));
         }
     } catch (const std::exception& e) {
         std::cerr << "Error: " << e.what() << std::endl;